@@ -0,0 +1,237 @@
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <ranges>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include "Infra/Utility/Hash.h"
+#include "Infra/Utility/String.h"
+
+/* String benchmark, prints one line per case:
+ *   GB/s      input bytes processed per second, best of REPEAT_COUNT runs
+ *   pieces    pieces produced per run, guards against the work being optimized away
+ * "ranges" is the std::views::split implementation String::Split used before.
+ * The utf-8 cases run over ascii, mixed and cjk text and report the code point count as pieces.
+ * The search cases look for a needle of the given size that only occurs at the end of the input.
+ * The parse cases convert a column of integers with the given digit count, GB/s counts field bytes.
+ * The hash cases hash every field of the given size, pieces is a checksum of the hashes.
+ * Usage: infra_bench_string [input megabytes]
+ */
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr int REPEAT_COUNT = 10;
+
+using SplitFunc = std::function<size_t(const std::string&)>;
+
+static size_t RangesSplitView(const std::string& input)
+{
+    std::vector<std::string_view> result;
+    for (const auto& element : std::views::split(input, ','))
+        result.emplace_back(element.begin(), element.end());
+
+    return result.size();
+}
+
+static size_t RangesSplit(const std::string& input)
+{
+    std::vector<std::string> result;
+    for (const auto& element : std::views::split(input, ','))
+        result.emplace_back(element.begin(), element.end());
+
+    return result.size();
+}
+
+static std::string MakeInput(size_t size, size_t averageFieldSize)
+{
+    std::mt19937 random(7);
+    std::uniform_int_distribution<size_t> fieldSize(averageFieldSize / 2, averageFieldSize + averageFieldSize / 2);
+
+    std::string input;
+    input.reserve(size + averageFieldSize * 2);
+    while (input.size() < size)
+    {
+        input.append(fieldSize(random), 'a' + static_cast<char>(random() % 26));
+        input.push_back(',');
+    }
+
+    return input;
+}
+
+static void RunCase(const char* name, size_t fieldSize, const std::string& input, const SplitFunc& func)
+{
+    double bestSeconds = 1e30;
+    size_t pieces = 0;
+    for (int i = 0; i < REPEAT_COUNT; i++)
+    {
+        const auto begin = Clock::now();
+        pieces = func(input);
+        bestSeconds = std::min(bestSeconds, std::chrono::duration<double>(Clock::now() - begin).count());
+    }
+
+    std::printf("%-16s %-8zu %10.2f %12zu\n", name, fieldSize, static_cast<double>(input.size()) / bestSeconds / 1e9, pieces);
+}
+
+int main(int argc, char** argv)
+{
+    const size_t inputSize = (argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64) * 1024 * 1024;
+
+    struct SplitCase
+    {
+        const char* name;
+        SplitFunc func;
+    };
+
+    const SplitCase splitCases[] =
+    {
+        { "ranges view", RangesSplitView },
+        { "SplitView", [](const std::string& input) -> size_t { return Infra::String::SplitView(input, ',').size(); } },
+        { "ranges string", RangesSplit },
+        { "Split", [](const std::string& input) -> size_t { return Infra::String::Split(input, ',').size(); } },
+        { "SplitLazy", [](const std::string& input) -> size_t
+            {
+                size_t count = 0;
+                for (const auto piece : Infra::String::SplitLazy(input, ','))
+                {
+                    (void)piece;
+                    count++;
+                }
+
+                return count;
+            } },
+        { "CountByte", [](const std::string& input) -> size_t { return Infra::String::CountByte(input.data(), input.data() + input.size(), ','); } },
+    };
+
+    std::printf("%-16s %-8s %10s %12s\n", "case", "field", "GB/s", "pieces");
+    for (const size_t fieldSize : { 4, 16, 64, 256, 4096 })
+    {
+        const std::string input = MakeInput(inputSize, fieldSize);
+        for (const auto& splitCase : splitCases)
+            RunCase(splitCase.name, fieldSize, input, splitCase.func);
+    }
+
+    const SplitCase utf8Cases[] =
+    {
+        { "ValidateUtf8", [](const std::string& input) -> size_t { return Infra::String::ValidateUtf8(input) ? 1 : 0; } },
+        { "CountCodePoints", [](const std::string& input) -> size_t { return Infra::String::CountCodePoints(input); } },
+    };
+
+    struct TextCase
+    {
+        const char* name;
+        std::string unit;
+    };
+
+    const TextCase textCases[] =
+    {
+        { "ascii", "plain ascii text, " },
+        { "mixed", "caf\xc3\xa9 \xe6\xb5\x8b\xe8\xaf\x95 \xf0\x9f\x98\x80 text, " },
+        { "cjk", "\xe6\xb5\x8b\xe8\xaf\x95\xe6\x96\x87\xe6\x9c\xac" },
+    };
+
+    for (const auto& textCase : textCases)
+    {
+        std::string input;
+        input.reserve(inputSize + textCase.unit.size());
+        while (input.size() < inputSize)
+            input += textCase.unit;
+
+        std::printf("%s\n", textCase.name);
+        for (const auto& utf8Case : utf8Cases)
+            RunCase(utf8Case.name, 0, input, utf8Case.func);
+    }
+
+    const std::string text = MakeInput(inputSize, 16);
+    for (const size_t needleSize : { 2, 8, 32, 128 })
+    {
+        const std::string needle = text.substr(text.size() / 2, needleSize - 1) + '#';
+        const std::string input = text + needle;
+
+        const SplitCase searchCases[] =
+        {
+            { "string find", [&needle](const std::string& input) -> size_t { return std::string_view(input).find(needle); } },
+            { "Find", [&needle](const std::string& input) -> size_t { return Infra::String::Find(input, needle); } },
+        };
+
+        for (const auto& searchCase : searchCases)
+            RunCase(searchCase.name, needleSize, input, searchCase.func);
+    }
+
+    for (const size_t digitCount : { 3, 8, 16 })
+    {
+        std::mt19937_64 random(1);
+        std::vector<std::string> fieldStrs(inputSize / (digitCount + 1));
+        std::string input;
+        for (auto& field : fieldStrs)
+        {
+            field = std::to_string(random() % 9 + 1);
+            while (field.size() < digitCount)
+                field.push_back(static_cast<char>('0' + random() % 10));
+
+            input += field;
+        }
+
+        const std::vector<std::string_view> fields(fieldStrs.begin(), fieldStrs.end());
+
+        const SplitCase parseCases[] =
+        {
+            { "stoll", [&fieldStrs](const std::string&) -> size_t
+                {
+                    size_t sum = 0;
+                    for (const auto& field : fieldStrs)
+                        sum += static_cast<size_t>(std::stoll(field));
+
+                    return sum;
+                } },
+            { "ParseColumn", [&fields](const std::string&) -> size_t
+                {
+                    std::vector<int64_t> values;
+                    Infra::String::ParseColumn<int64_t>(fields, values);
+
+                    size_t sum = 0;
+                    for (const int64_t value : values)
+                        sum += static_cast<size_t>(value);
+
+                    return sum;
+                } },
+        };
+
+        for (const auto& parseCase : parseCases)
+            RunCase(parseCase.name, digitCount, input, parseCase.func);
+    }
+
+    for (const size_t keySize : { 8, 32, 1024 })
+    {
+        const std::string input = MakeInput(inputSize, keySize);
+        std::vector<std::string_view> keys;
+        for (size_t pos = 0; pos + keySize <= input.size(); pos += keySize)
+            keys.push_back(std::string_view(input).substr(pos, keySize));
+
+        const SplitCase hashCases[] =
+        {
+            { "std::hash", [&keys](const std::string&) -> size_t
+                {
+                    size_t sum = 0;
+                    for (const auto key : keys)
+                        sum += std::hash<std::string_view>()(key);
+
+                    return sum;
+                } },
+            { "Hash::Of", [&keys](const std::string&) -> size_t
+                {
+                    size_t sum = 0;
+                    for (const auto key : keys)
+                        sum += static_cast<size_t>(Infra::Hash::Of(key));
+
+                    return sum;
+                } },
+        };
+
+        for (const auto& hashCase : hashCases)
+            RunCase(hashCase.name, keySize, input, hashCase.func);
+    }
+
+    return 0;
+}
@@ -7,7 +7,7 @@ namespace Infra
     class TcpSocket: public Socket
     {
     public:
-        static std::optional<Socket> Create(IpAddress::Family af = IpAddress::Family::IpV4);
+        static std::optional<TcpSocket> Create(IpAddress::Family af = IpAddress::Family::IpV4);
 
     public:
         // Connect an endpoint.
@@ -20,7 +20,7 @@ namespace Infra
         std::optional<EndPoint> GetRemoteEndpoint() const;
 
         // Send
-        std::pair<SocketState, size_t> Send(void* pData, size_t size);
+        std::pair<SocketState, size_t> Send(const void* pData, size_t size);
         std::pair<SocketState, size_t> Receive(void* pBuffer, size_t size);
 
     private:
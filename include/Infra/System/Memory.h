@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <string>
 
 namespace Infra
 {
@@ -14,6 +15,11 @@ namespace Infra
         static bool VirtualCommit(void* addr, size_t size);
         static void VirtualRelease(void* addr, size_t size);
         static size_t CurrentPageSize();
+
+        // Map file read-write and shared, the file is created or resized to size. Writes reach
+        // the file through the page cache, so they survive a crash of the process.
+        static void* MapFile(const std::string& path, size_t size);
+        static void UnmapFile(void* addr, size_t size);
     };
 
 }
\ No newline at end of file
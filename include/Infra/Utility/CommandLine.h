@@ -7,6 +7,9 @@
 #include <functional>
 #include <unordered_map>
 #include <optional>
+#include <stdexcept>
+#include "Hash.h"
+#include "String.h"
 #include "../Assert.h"
 
 namespace Infra
@@ -129,6 +132,13 @@ namespace Infra
         void Parse(int argc, char** argv);
 
     private:
+        // Character types keep the stream path, "x" is read as the character 'x'.
+        template<typename T>
+        static constexpr bool IS_NUMBER = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>
+            && !std::is_same_v<T, char> && !std::is_same_v<T, signed char> && !std::is_same_v<T, unsigned char>
+            && !std::is_same_v<T, wchar_t> && !std::is_same_v<T, char8_t>
+            && !std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t>;
+
         template<typename T>
         static T Convert(const std::string& str);
 
@@ -145,7 +155,7 @@ namespace Infra
 
         // Options
         std::vector<Option*> _allOptions;
-        std::unordered_map<std::string, Option*> _fullNameOptionMap;
+        std::unordered_map<std::string, Option*, StringHash, std::equal_to<>> _fullNameOptionMap;
         std::unordered_map<char, Option*> _shortNameOptionMap;
 
         // Help message
@@ -155,22 +165,33 @@ namespace Infra
     template<typename T>
     T CommandLine::Convert(const std::string& str)
     {
-        if constexpr (std::is_same_v<T, std::string>)           return str;
-        if constexpr (std::is_same_v<T, int>)                   return std::stoi(str);
-        if constexpr (std::is_same_v<T, float>)                 return std::stof(str);
-        if constexpr (std::is_same_v<T, double>)                return std::stod(str);
-        if constexpr (std::is_same_v<T, long>)                  return std::stol(str);
-        if constexpr (std::is_same_v<T, unsigned long>)         return std::stoul(str);
-        if constexpr (std::is_same_v<T, long long>)             return std::stoll(str);
-        if constexpr (std::is_same_v<T, unsigned long long>)    return std::stoull(str);
-        if constexpr (std::is_same_v<T, long double>)           return std::stold(str);
-
-        T result;
-        std::istringstream strStream(str);
-        if (!(strStream >> result && strStream.eof()))
-            throw std::bad_cast();
-
-        return result;
+        if constexpr (std::is_same_v<T, std::string>)
+            return str;
+        else if constexpr (IS_NUMBER<T>)
+        {
+            // Same exceptions as the std::sto* family, but the whole value must be a number.
+            String::ParseError error = String::ParseError::None;
+            const std::optional<T> value = String::Parse<T>(str, &error);
+            if (!value.has_value())
+            {
+                if (error == String::ParseError::OutOfRange)
+                    throw std::out_of_range(str);
+
+                throw std::invalid_argument(str);
+            }
+
+            return *value;
+        }
+        else
+        {
+            // Nothing may follow the value. Reading one character does not set eof, so peek instead.
+            T result;
+            std::istringstream strStream(str);
+            if (!(strStream >> result) || strStream.peek() != std::istringstream::traits_type::eof())
+                throw std::bad_cast();
+
+            return result;
+        }
     }
 
     template<CmdOptionType type>
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include "../PlatformDefine.h"
+
+#if COMPILER_MSVC
+#   include <intrin.h>
+#endif
+
+namespace Infra
+{
+    /* Fast non-cryptographic 64 bit hash following wyhash final4: inputs up to 16 bytes take two
+     * overlapping reads and one 64x64->128 multiplication, longer ones are folded 48 bytes per
+     * round in three independent lanes. The same function runs at compile time, so
+     *
+     *     switch (Hash::Of(command))
+     *     {
+     *         case Hash::Of("start"): ...
+     *     }
+     *
+     * works, with the usual caveat that a hash match still has to be confirmed by a compare.
+     * Values are stable across platforms and runs for the same seed, but not a persistent format.
+     */
+    class Hash
+    {
+    public:
+        Hash() = delete;
+
+    public:
+        static constexpr uint64_t Of(std::string_view str, uint64_t seed = 0)
+        {
+            const char* p = str.data();
+            const size_t size = str.size();
+
+            seed ^= Mix(seed ^ SECRET[0], SECRET[1]);
+
+            uint64_t a;
+            uint64_t b;
+            if (size <= 16)
+            {
+                if (size >= 4)
+                {
+                    const size_t offset = (size >> 3) << 2;
+                    a = (Read4(p) << 32) | Read4(p + offset);
+                    b = (Read4(p + size - 4) << 32) | Read4(p + size - 4 - offset);
+                }
+                else if (size > 0)
+                {
+                    a = Read3(p, size);
+                    b = 0;
+                }
+                else
+                {
+                    a = 0;
+                    b = 0;
+                }
+            }
+            else
+            {
+                size_t remain = size;
+                if (remain >= 48)
+                {
+                    uint64_t seed1 = seed;
+                    uint64_t seed2 = seed;
+                    do
+                    {
+                        seed = Mix(Read8(p) ^ SECRET[1], Read8(p + 8) ^ seed);
+                        seed1 = Mix(Read8(p + 16) ^ SECRET[2], Read8(p + 24) ^ seed1);
+                        seed2 = Mix(Read8(p + 32) ^ SECRET[3], Read8(p + 40) ^ seed2);
+                        p += 48;
+                        remain -= 48;
+                    } while (remain >= 48);
+
+                    seed ^= seed1 ^ seed2;
+                }
+
+                while (remain > 16)
+                {
+                    seed = Mix(Read8(p) ^ SECRET[1], Read8(p + 8) ^ seed);
+                    p += 16;
+                    remain -= 16;
+                }
+
+                a = Read8(p + remain - 16);
+                b = Read8(p + remain - 8);
+            }
+
+            a ^= SECRET[1];
+            b ^= seed;
+            Multiply(a, b);
+            return Mix(a ^ SECRET[0] ^ size, b ^ SECRET[1]);
+        }
+
+        /// \brief Same value as Of for the same bytes. Not an overload of Of, so that Of("key", seed)
+        /// can never be taken for a pointer and a size.
+        static uint64_t Bytes(std::span<const std::byte> bytes, uint64_t seed = 0)
+        {
+            return Of(std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size()), seed);
+        }
+
+        static uint64_t Bytes(const void* data, size_t size, uint64_t seed = 0)
+        {
+            return Of(std::string_view(static_cast<const char*>(data), size), seed);
+        }
+
+        /// \brief Mix \p value into \p seed, for hashing several fields into one value.
+        static constexpr uint64_t Combine(uint64_t seed, uint64_t value)
+        {
+            return Mix(seed ^ SECRET[0], value ^ SECRET[1]);
+        }
+
+    private:
+        static constexpr uint64_t SECRET[4] =
+        {
+            0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+        };
+
+        // Full 128 bit product, low half to lhs and high half to rhs.
+        static constexpr void Multiply(uint64_t& lhs, uint64_t& rhs)
+        {
+            if (!std::is_constant_evaluated())
+            {
+#if COMPILER_MSVC && defined(_M_X64)
+                lhs = _umul128(lhs, rhs, &rhs);
+                return;
+#elif defined(__SIZEOF_INT128__)
+                const unsigned __int128 product = static_cast<unsigned __int128>(lhs) * rhs;
+                lhs = static_cast<uint64_t>(product);
+                rhs = static_cast<uint64_t>(product >> 64);
+                return;
+#endif
+            }
+
+            // Schoolbook on 32 bit halves, for constant evaluation and targets without a 128 bit type.
+            const uint64_t lhsHigh = lhs >> 32;
+            const uint64_t lhsLow = static_cast<uint32_t>(lhs);
+            const uint64_t rhsHigh = rhs >> 32;
+            const uint64_t rhsLow = static_cast<uint32_t>(rhs);
+
+            const uint64_t lowLow = lhsLow * rhsLow;
+            const uint64_t lowHigh = lhsLow * rhsHigh;
+            const uint64_t highLow = lhsHigh * rhsLow;
+            const uint64_t highHigh = lhsHigh * rhsHigh;
+
+            const uint64_t middle = (lowLow >> 32) + static_cast<uint32_t>(lowHigh) + static_cast<uint32_t>(highLow);
+            lhs = (middle << 32) | static_cast<uint32_t>(lowLow);
+            rhs = highHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+        }
+
+        static constexpr uint64_t Mix(uint64_t lhs, uint64_t rhs)
+        {
+            Multiply(lhs, rhs);
+            return lhs ^ rhs;
+        }
+
+        // Little endian reads, byte by byte at compile time where memcpy is not allowed.
+        template <size_t SIZE>
+        static constexpr uint64_t ReadLittleEndian(const char* p)
+        {
+            if (!std::is_constant_evaluated())
+            {
+                std::conditional_t<SIZE == 8, uint64_t, uint32_t> value;
+                std::memcpy(&value, p, SIZE);
+                return value;
+            }
+
+            uint64_t value = 0;
+            for (size_t i = 0; i < SIZE; i++)
+                value |= static_cast<uint64_t>(static_cast<uint8_t>(p[i])) << (i * 8);
+
+            return value;
+        }
+
+        static constexpr uint64_t Read8(const char* p)
+        {
+            return ReadLittleEndian<8>(p);
+        }
+
+        static constexpr uint64_t Read4(const char* p)
+        {
+            return ReadLittleEndian<4>(p);
+        }
+
+        // 1 to 3 bytes: first, middle and last.
+        static constexpr uint64_t Read3(const char* p, size_t size)
+        {
+            return (static_cast<uint64_t>(static_cast<uint8_t>(p[0])) << 16)
+                | (static_cast<uint64_t>(static_cast<uint8_t>(p[size >> 1])) << 8)
+                | static_cast<uint8_t>(p[size - 1]);
+        }
+    };
+
+    /* Transparent string hasher: with std::equal_to<> as the key equal, an unordered container
+     * keyed by std::string can be searched with a string_view or a literal without building a
+     * temporary std::string.
+     */
+    struct StringHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view str) const noexcept
+        {
+            return static_cast<size_t>(Hash::Of(str));
+        }
+    };
+}
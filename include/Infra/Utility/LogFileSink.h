@@ -0,0 +1,75 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Logger.h"
+#include "NonCopyable.h"
+
+namespace Infra
+{
+    /* Buffered file sink, lines are collected into one large chunk and written with a single
+     * append write. The active file is <directory>/<baseName>.log, on rotation it is renamed
+     * to <baseName>.<YYYYmmdd-HHMMSS>.log and only the newest maxFileCount rotated files are kept.
+     * A file that can not be opened or written is opened again on later writes, waiting twice as
+     * long after each failure, lines written meanwhile are dropped.
+     */
+    class LogFileSink : public LogSink, public NonCopyable
+    {
+    public:
+        enum class SyncPolicy: int
+        {
+            Never = 0,          // Leave it to the OS
+            OnFlush = 1,        // fsync on Logger::Flush and rotation
+            EveryWrite = 2      // fsync after every chunk write
+        };
+
+        struct Config
+        {
+            std::string directory = "logs";
+            std::string baseName = "log";
+            size_t bufferSize = 1024 * 1024;
+            uint32_t maxBufferDelayMs = 200;            // Write buffered lines older than this, checked on every batch and tick
+            uint64_t maxFileSize = 256 * 1024 * 1024;   // 0 disables size rotation
+            uint32_t rotateIntervalSeconds = 0;         // 0 disables time rotation
+            uint32_t maxFileCount = 10;                 // Rotated files to keep, 0 keeps all
+            SyncPolicy syncPolicy = SyncPolicy::OnFlush;
+        };
+
+    public:
+        explicit LogFileSink(const Config& config);
+        ~LogFileSink() override;
+
+    public:
+        void OnBatch(std::span<const LogRecord> records) override;
+        void OnFlush() override;
+        void OnTick(int64_t timestamp) override;
+
+        bool IsOpen() const;
+        std::string GetFilePath() const;
+
+    private:
+        void AppendRecord(const LogRecord& record);
+        bool OpenFile();
+        void CloseFile();
+        void DelayReopen(int64_t now);
+        void WriteBuffer();
+        void Rotate();
+        void RemoveExpiredFiles();
+
+    private:
+        Config _config;
+        std::string _filePath;
+
+        mutable std::mutex _mutex;
+        intptr_t _handle;   // fd on posix, HANDLE on windows, -1 when closed
+        uint64_t _fileSize;
+        int64_t _nextRotateTime;
+        int64_t _nextOpenTime;      // Earliest retry after a failed open or write
+        int64_t _openRetryDelay;
+
+        std::vector<char> _buffer;
+        int64_t _bufferStartTime;
+    };
+}
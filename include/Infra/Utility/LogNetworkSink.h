@@ -0,0 +1,97 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <condition_variable>
+#include "Logger.h"
+#include "NonCopyable.h"
+#include "Infra/Network/TcpSocket.h"
+
+namespace Infra
+{
+    /* Ships records to a collector over tcp. OnBatch only encodes frames into a bounded
+     * backlog under a short lock, a sender thread owns the socket, sends non-blocking and
+     * reconnects with exponential backoff, so logging threads never wait on the network.
+     * Records that do not fit into the backlog are dropped and counted.
+     *
+     * Frame, integers in network byte order:
+     *   uint32 size of the rest of the frame
+     *   uint8  level, uint16 category id, int64 timestamp (ns since epoch), uint64 thread id
+     *   uint16 category name size, category name, message (rest of the frame)
+     *
+     * Only tcp is supported, Infra has no udp socket yet.
+     */
+    class LogNetworkSink : public LogSink, public NonCopyable
+    {
+    public:
+        struct Config
+        {
+            size_t maxBacklogSize = 8 * 1024 * 1024;    // Encoded bytes waiting to be sent
+            size_t sendChunkSize = 64 * 1024;           // Bytes passed to one send call
+            uint32_t sendIntervalMs = 50;               // Sender wakes at least this often
+            uint32_t connectTimeoutMs = 1000;
+            uint32_t minReconnectDelayMs = 100;
+            uint32_t maxReconnectDelayMs = 30000;
+            uint32_t flushTimeoutMs = 1000;             // Upper bound of OnFlush waiting for the backlog
+        };
+
+        struct Statistics
+        {
+            uint64_t sentRecords = 0;
+            uint64_t droppedRecords = 0;    // Backlog full or lost with a broken connection
+            uint64_t connectCount = 0;      // Successful connections, the first one included
+            bool connected = false;
+        };
+
+    public:
+        explicit LogNetworkSink(const EndPoint& endpoint);
+        LogNetworkSink(const EndPoint& endpoint, const Config& config);
+        ~LogNetworkSink() override;
+
+    public:
+        void OnBatch(std::span<const LogRecord> records) override;
+
+        // Wait until the backlog is sent, at most flushTimeoutMs.
+        void OnFlush() override;
+
+        Statistics GetStatistics() const;
+
+    private:
+        void SenderLoop();
+        bool TryConnect();
+        bool SendPending();
+        void DropPartialFrame();
+
+    private:
+        const EndPoint _endpoint;
+        const Config _config;
+
+        // Backlog appended by OnBatch, swapped into _sending by the sender.
+        mutable std::mutex _mutex;
+        std::condition_variable _wakeCondition;
+        std::condition_variable _idleCondition;
+        std::vector<char> _backlog;
+        size_t _backlogRecords;
+        bool _sendingBusy;
+        bool _stop;
+
+        // Owned by the sender thread.
+        std::optional<TcpSocket> _socket;
+        std::vector<char> _sending;
+        size_t _sendingOffset;
+        size_t _sendingRecords;
+        uint32_t _reconnectDelayMs;
+        int64_t _nextConnectTime;
+
+        std::atomic<uint64_t> _sentRecords;
+        std::atomic<uint64_t> _droppedRecords;
+        std::atomic<uint64_t> _connectCount;
+        std::atomic<bool> _connected;
+
+        std::thread _sender;
+    };
+}
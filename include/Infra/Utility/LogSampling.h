@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <source_location>
+#include "Logger.h"
+
+namespace Infra
+{
+    // Call count of one log site, used by INFRA_LOG_EVERY_N and INFRA_LOG_FIRST_N.
+    class LogSiteCounter
+    {
+    public:
+        constexpr LogSiteCounter() = default;
+
+    public:
+        // True for the 1st, (n+1)th, (2n+1)th ... call.
+        bool ShouldLogEveryN(uint32_t n)
+        {
+            return _count.fetch_add(1, std::memory_order_relaxed) % (n == 0 ? 1 : n) == 0;
+        }
+
+        // True for the first n calls, a single relaxed load once they are used up.
+        bool ShouldLogFirstN(uint32_t n)
+        {
+            if (_count.load(std::memory_order_relaxed) >= n)
+                return false;
+
+            return _count.fetch_add(1, std::memory_order_relaxed) < n;
+        }
+
+    private:
+        std::atomic<uint64_t> _count = 0;
+    };
+
+    /* Token bucket of one log site, implemented as GCRA so the bucket is one arrival time.
+     * A site allows `burst` messages at once and one message per interval on average, with
+     * millisecond resolution, so rates above 1000 per second are clamped to 1000.
+     *
+     * Arrival time and suppressed count share one word: rejecting costs one relaxed load of
+     * the clock cached by Logger and one relaxed add on the site, no clock is read. The
+     * "Suppressed N messages" summary is logged by the next passing call, or by the logger's
+     * background thread once the site's window reopens, or by Logger::Flush. A summary not
+     * carried by a passing call takes the place of one message of the site.
+     */
+    class LogRateLimiter
+    {
+    public:
+        constexpr LogRateLimiter(Logger::Level level, int64_t intervalNs, uint32_t burst, const std::source_location& location = std::source_location::current())
+            : _level(level)
+            , _location(location)
+            , _interval(IntervalTicks(intervalNs))
+            , _tolerance(IntervalTicks(intervalNs) * (burst > 0 ? burst - 1 : 0))
+        {
+        }
+
+        static constexpr LogRateLimiter FromRate(Logger::Level level, double ratePerSecond, uint32_t burst, const std::source_location& location = std::source_location::current())
+        {
+            return LogRateLimiter(level, ratePerSecond > 0 ? static_cast<int64_t>(1e9 / ratePerSecond) : INT64_MAX / 4, burst, location);
+        }
+
+        static constexpr LogRateLimiter FromInterval(Logger::Level level, double intervalSeconds, const std::source_location& location = std::source_location::current())
+        {
+            return LogRateLimiter(level, static_cast<int64_t>(intervalSeconds * 1e9), 1, location);
+        }
+
+    public:
+        // Return true if message may be logged, suppressed receives messages dropped since the last summary.
+        bool TryAcquire(uint64_t& suppressed)
+        {
+            const uint64_t now = static_cast<uint64_t>(Logger::GetCachedTimestamp()) / TICK_NS;
+            const uint64_t state = _state.fetch_add(1, std::memory_order_relaxed);
+            if (now + _tolerance < (state >> COUNT_BITS))
+            {
+                // First suppression since the last summary, or the count is about to need spilling.
+                const uint64_t count = (state & COUNT_MASK) + 1;
+                if (count == 1 || count == COUNT_SPILL)
+                    OnSuppressed(count);
+
+                return false;
+            }
+
+            return TryPass(state, suppressed);
+        }
+
+        // Log "Suppressed N messages" at the call site.
+        static void ReportSuppressed(Logger::Level level, uint64_t count, const std::source_location& location = std::source_location::current());
+
+        // Log the summary of every site with suppressed messages whose window has reopened, or of
+        // every such site when force is set. Return true if a site still holds suppressed messages.
+        static bool ReportPending(bool force);
+
+    private:
+        // Low bits count calls since the last summary, high bits are the arrival time in milliseconds
+        // since epoch. Counts are moved to _spilled before they can carry into the arrival time.
+        static constexpr int COUNT_BITS = 22;
+        static constexpr uint64_t COUNT_MASK = (uint64_t(1) << COUNT_BITS) - 1;
+        static constexpr uint64_t COUNT_SPILL = uint64_t(1) << (COUNT_BITS - 1);
+        static constexpr int64_t TICK_NS = 1000000;
+
+        static constexpr uint64_t IntervalTicks(int64_t intervalNs)
+        {
+            return intervalNs > TICK_NS ? static_cast<uint64_t>(intervalNs / TICK_NS) : 1;
+        }
+
+        bool TryPass(uint64_t seen, uint64_t& suppressed);
+        void OnSuppressed(uint64_t count);
+        bool ReportIfOpen(uint64_t now, bool force);
+
+    private:
+        const Logger::Level _level;
+        const std::source_location _location;
+        const uint64_t _interval;
+        const uint64_t _tolerance;
+        std::atomic<uint64_t> _state = 0;
+        std::atomic<uint64_t> _spilled = 0;
+
+        // Sites are linked into a list the first time they suppress, and never leave it.
+        std::atomic<bool> _listed = false;
+        LogRateLimiter* _pNextListed = nullptr;
+    };
+}
+
+#define INFRA_LOG_EVERY_N(level, n, ...) \
+    do { \
+        static constinit ::Infra::LogSiteCounter infraLogSite; \
+        if (::Infra::Logger::IsEnabled(::Infra::Logger::Level::level) && infraLogSite.ShouldLogEveryN(n)) \
+            ::Infra::Logger::Log(::Infra::Logger::Level::level, __VA_ARGS__); \
+    } while (0)
+
+#define INFRA_LOG_FIRST_N(level, n, ...) \
+    do { \
+        static constinit ::Infra::LogSiteCounter infraLogSite; \
+        if (::Infra::Logger::IsEnabled(::Infra::Logger::Level::level) && infraLogSite.ShouldLogFirstN(n)) \
+            ::Infra::Logger::Log(::Infra::Logger::Level::level, __VA_ARGS__); \
+    } while (0)
+
+#define INFRA_LOG_RATE_LIMITED_IMPL(level, limiter, ...) \
+    do { \
+        static constinit ::Infra::LogRateLimiter infraLogSite = limiter; \
+        uint64_t infraLogSuppressed = 0; \
+        if (::Infra::Logger::IsEnabled(::Infra::Logger::Level::level) && infraLogSite.TryAcquire(infraLogSuppressed)) \
+        { \
+            if (infraLogSuppressed > 0) \
+                ::Infra::LogRateLimiter::ReportSuppressed(::Infra::Logger::Level::level, infraLogSuppressed); \
+            ::Infra::Logger::Log(::Infra::Logger::Level::level, __VA_ARGS__); \
+        } \
+    } while (0)
+
+// At most one message per `seconds` from this call site, `seconds` must be a constant expression.
+#define INFRA_LOG_EVERY_T(level, seconds, ...) \
+    INFRA_LOG_RATE_LIMITED_IMPL(level, ::Infra::LogRateLimiter::FromInterval(::Infra::Logger::Level::level, seconds), __VA_ARGS__)
+
+// Token bucket per call site, `ratePerSecond` on average with bursts of `burst` messages. Both must be constant expressions.
+#define INFRA_LOG_RATE_LIMITED(level, ratePerSecond, burst, ...) \
+    INFRA_LOG_RATE_LIMITED_IMPL(level, ::Infra::LogRateLimiter::FromRate(::Infra::Logger::Level::level, ratePerSecond, burst), __VA_ARGS__)
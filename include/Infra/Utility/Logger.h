@@ -2,6 +2,16 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
+#include <span>
+#include <memory>
+#include <atomic>
+#include <tuple>
+#include <source_location>
+#include <new>
+#include <type_traits>
+#include <cstdint>
+#include "../Assert.h"
 
 #ifdef __clang__
 #   if __clang_major__ >= 17
@@ -17,76 +27,517 @@
 #include <format>
 #endif
 
+/* Compile time minimum level, same values as Logger::Level, 5 turns logging off.
+ * INFRA_LOG_* macros below it expand to nothing, arguments are not evaluated.
+ */
+#define INFRA_LOG_LEVEL_TRACE   0
+#define INFRA_LOG_LEVEL_DEBUG   1
+#define INFRA_LOG_LEVEL_INFO    2
+#define INFRA_LOG_LEVEL_WARNING 3
+#define INFRA_LOG_LEVEL_ERROR   4
+#define INFRA_LOG_LEVEL_OFF     5
+
+#ifndef INFRA_LOG_MIN_LEVEL
+#   ifdef NDEBUG
+#       define INFRA_LOG_MIN_LEVEL INFRA_LOG_LEVEL_INFO
+#   else
+#       define INFRA_LOG_MIN_LEVEL INFRA_LOG_LEVEL_TRACE
+#   endif
+#endif
+
+// Size of the per-thread buffer synchronous format calls are formatted into, longer messages are truncated.
+#ifndef INFRA_LOG_FORMAT_BUFFER_SIZE
+#   define INFRA_LOG_FORMAT_BUFFER_SIZE 4096
+#endif
+
 namespace Infra
 {
+    class LogSink;
+    struct LogRecord;
+
+    // Named log category, declare with INFRA_LOG_CATEGORY. Id indexes the per-category level table.
+    struct LogCategory
+    {
+        uint16_t id;
+        const char* name;
+    };
+
     class Logger
     {
     public:
         using LogCallBack = void(*)(const char*);
+        using LogRecordCallBack = void(*)(const LogRecord&);
 
         enum class Level: int
         {
-            Info = 0,
-            Warning = 1,
-            Error = 2
+            Trace = INFRA_LOG_LEVEL_TRACE,
+            Debug = INFRA_LOG_LEVEL_DEBUG,
+            Info = INFRA_LOG_LEVEL_INFO,
+            Warning = INFRA_LOG_LEVEL_WARNING,
+            Error = INFRA_LOG_LEVEL_ERROR
+        };
+
+        static constexpr Level COMPILE_TIME_MIN_LEVEL = static_cast<Level>(INFRA_LOG_MIN_LEVEL);
+        static constexpr int LEVEL_COUNT = 5;
+
+        // Category ids are dense in [0, MAX_CATEGORY_COUNT), 0 is used by logs without a category.
+        static constexpr size_t MAX_CATEGORY_COUNT = 256;
+        static constexpr LogCategory DEFAULT_CATEGORY { 0, "Default" };
+
+        // Length of "YYYY-MM-DD HH:MM:SS.uuuuuu".
+        static constexpr size_t TIMESTAMP_SIZE = 26;
+
+        enum class OverflowPolicy: int
+        {
+            Block = 0,          // Producer waits until the queue has room, a sink logging on the worker drops instead
+            DropNewest = 1,     // Discard the message being logged
+            DropOldest = 2      // Discard the oldest queued message
+        };
+
+        struct AsyncConfig
+        {
+            size_t queueCapacity = 8192;    // Rounded up to power of two
+            OverflowPolicy overflowPolicy = OverflowPolicy::Block;
+        };
+
+        struct AsyncOverflowCount
+        {
+            uint64_t blocked = 0;
+            uint64_t droppedNewest = 0;
+            uint64_t droppedOldest = 0;
+        };
+
+        struct LevelStatistics
+        {
+            uint64_t accepted = 0;      // Passed the filter, rejected calls are not counted to keep the check a single load
+            uint64_t dropped = 0;       // Accepted but discarded by the async overflow policy
+            uint64_t bytes = 0;         // Message bytes of accepted records
+        };
+
+        struct Statistics
+        {
+            LevelStatistics levels[LEVEL_COUNT];
+            AsyncOverflowCount asyncOverflow;
+            size_t queueCapacity = 0;
+            size_t queueHighWaterMark = 0;  // Most entries seen waiting in the async queue
+            uint64_t sinkCallCount = 0;     // Batches and flushes passed to sinks
+            uint64_t sinkTimeNs = 0;        // Total time spent inside sinks
+            uint64_t maxSinkTimeNs = 0;     // Longest single batch or flush
+        };
+
+        // Per-thread staging used to batch records for LogSink in sync mode.
+        struct BatchConfig
+        {
+            size_t stagingRecordCount = 256;
+            size_t stagingBufferSize = 64 * 1024;
+            uint32_t maxStagingDelayMs = 100;     // Checked by a background thread too, idle threads are flushed as well
         };
 
     public:
         Logger() = delete;
 
     public:
+        // Global level, also applied to every category without its own level.
         static void SetFilterLevel(Level targetLevel);
 
         static Level GetCurrentFilterLevel();
 
+        // Override level of one category, reset makes it follow the global level again.
+        static void SetCategoryLevel(const LogCategory& category, Level targetLevel);
+        static void ResetCategoryLevel(const LogCategory& category);
+        static Level GetCategoryLevel(const LogCategory& category);
+
+        // Record the category as the owner of its id, called by INFRA_LOG_CATEGORY at startup.
+        // False when another category already took the id, registering the same one again is fine.
+        static bool RegisterCategory(const LogCategory& category);
+
+        // Compile time level is checked first, so calls below it fold away. The runtime
+        // check is one relaxed load of the category's effective level.
+        static bool IsEnabled(const LogCategory& category, Level level)
+        {
+            return static_cast<int>(level) >= static_cast<int>(COMPILE_TIME_MIN_LEVEL)
+                && static_cast<int>(level) >= static_cast<int>(_categoryLevel[category.id].level.load(std::memory_order_relaxed));
+        }
+
+        static bool IsEnabled(Level level)
+        {
+            return IsEnabled(DEFAULT_CATEGORY, level);
+        }
+
+        // Async mode, log calls push into a bounded lock-free queue and a background thread calls sinks.
+        static bool StartAsync();
+        static bool StartAsync(const AsyncConfig& config);
+        static void StopAsync();
+        static bool IsAsync();
+
+        // Block until every message logged before this call has been passed to sinks. Called from
+        // a sink on the async worker, records still queued are not waited for.
+        static void Flush();
+
+        // Batch sinks, receive all levels passing the filter. Records logged after AddSink returns
+        // reach the sink. RemoveSink delivers staged records, waits for batches in flight and
+        // flushes the sink, after it returns the logger neither calls nor holds the sink. Called
+        // from a sink callback, batches on the calling thread are not waited for.
+        static void AddSink(const std::shared_ptr<LogSink>& pSink);
+        static void RemoveSink(const std::shared_ptr<LogSink>& pSink);
+        static void SetBatchConfig(const BatchConfig& config);
+
+        /* Flight recorder, every record passing the filter is also copied into a ring buffer in
+         * a memory mapped file of fileSize bytes. Copying is a memcpy without syscalls, the OS
+         * writes the pages back even if the process crashes. On SIGSEGV, SIGABRT, SIGBUS, SIGFPE
+         * and SIGILL records still pending in the async queue are copied before the process dies,
+         * those lines carry the raw nanosecond timestamp since local time is not signal safe.
+         * The enabling thread and the async worker get an alternate signal stack, so a stack
+         * overflow is recorded too.
+         */
+        static bool EnableFlightRecorder(const std::string& path, size_t fileSize);
+        static void DisableFlightRecorder();
+
+        // Lines of a flight recorder file oldest first, e.g. after restart from a crash.
+        static std::string ReadFlightRecorder(const std::string& path);
+
+        static AsyncOverflowCount GetAsyncOverflowCount();
+
+        // Every thread counts into its own shard, a snapshot sums the shards without stopping loggers.
+        static Statistics GetStatistics();
+
+        // Upper case level name, e.g. "INFO".
+        static const char* GetLevelName(Level level);
+
+        // Nanoseconds since unix epoch from a coarse clock, the value stored in LogRecord::timestamp.
+        static int64_t GetCoarseTimestamp();
+
+        // Last coarse timestamp seen by the logger, one relaxed load instead of a clock read. Refreshed
+        // by every accepted record and by the background thread while rate limited sites suppress.
+        static int64_t GetCachedTimestamp()
+        {
+            return _cachedTimestamp.load(std::memory_order_relaxed);
+        }
+
+        // Format timestamp in local time, return written size or 0 if buffer is too small.
+        // Date and second part is cached per thread, so only the fraction is formatted in most calls.
+        static size_t FormatTimestamp(int64_t timestamp, char* pBuffer, size_t bufferSize);
+
+        // Callbacks and sinks may be added at any time. They are called without a lock,
+        // concurrently from every logging thread in sync mode, so they must be thread safe.
+        template <Level level>
+        static void AddLogCall(LogRecordCallBack pFunc)
+        {
+            AddRecordCallBack(level, pFunc);
+        }
+
         template <Level level>
         static void AddLogCall(LogCallBack pFunc)
         {
-            if constexpr (level == Level::Info)
-                _logInfoCallVec.push_back(pFunc);
-            else if constexpr (level == Level::Warning)
-                _logWarnCallVec.push_back(pFunc);
-            else if constexpr (level == Level::Error)
-                _logErrorCallVec.push_back(pFunc);
+            AddCallBack(level, pFunc);
         }
 
+        // Log with level chosen at runtime
+        static void Log(Level level, const std::string& message, const std::source_location& location = std::source_location::current());
+        static void Log(Level level, const char* message, const std::source_location& location = std::source_location::current());
+
+        // Log in category, filtered by the category's level
+        static void Log(const LogCategory& category, Level level, const std::string& message, const std::source_location& location = std::source_location::current());
+        static void Log(const LogCategory& category, Level level, const char* message, const std::source_location& location = std::source_location::current());
+
+        // Log trace
+        static void LogTrace(const std::string& message, const std::source_location& location = std::source_location::current());
+        static void LogTrace(const char* message, const std::source_location& location = std::source_location::current());
+
+        // Log debug
+        static void LogDebug(const std::string& message, const std::source_location& location = std::source_location::current());
+        static void LogDebug(const char* message, const std::source_location& location = std::source_location::current());
+
         // Log info
-        static void LogInfo(const std::string& message);
-        static void LogInfo(const char* message);
+        static void LogInfo(const std::string& message, const std::source_location& location = std::source_location::current());
+        static void LogInfo(const char* message, const std::source_location& location = std::source_location::current());
 
         // Log warn
-        static void LogWarn(const std::string& message);
-        static void LogWarn(const char* message);
+        static void LogWarn(const std::string& message, const std::source_location& location = std::source_location::current());
+        static void LogWarn(const char* message, const std::source_location& location = std::source_location::current());
 
         // Log error
-        static void LogError(const std::string& message);
-        static void LogError(const char* message);
+        static void LogError(const std::string& message, const std::source_location& location = std::source_location::current());
+        static void LogError(const char* message, const std::source_location& location = std::source_location::current());
 
 #if HAVE_STD_FORMAT
+        // Format string carrying the call site, the location defaults at the caller.
+        template <class... Types>
+        struct FormatWithLocation
+        {
+            template <class T>
+            consteval FormatWithLocation(const T& fmt, const std::source_location& loc = std::source_location::current()) // NOLINT(*-explicit-constructor)
+                : format(fmt)
+                , location(loc)
+            {
+            }
+
+            std::format_string<Types...> format;
+            std::source_location location;
+        };
+
+        template <class... Types>
+        using FormatString = FormatWithLocation<std::type_identity_t<Types>...>;
+
+        // Level is checked before formatting. In async mode arguments are copied into
+        // the queue and formatted on the worker thread, see DeferredArg for what is deferred.
+        template <class... Types>
+        static void Log(Level level, FormatString<Types...> Fmt, Types&&... Args)
+        {
+            LogFormat(DEFAULT_CATEGORY, level, Fmt.format, Fmt.location, std::forward<Types>(Args)...);
+        }
+
+        template <class... Types>
+        static void Log(const LogCategory& category, Level level, FormatString<Types...> Fmt, Types&&... Args)
+        {
+            LogFormat(category, level, Fmt.format, Fmt.location, std::forward<Types>(Args)...);
+        }
+
+        template <class... Types>
+        static void LogTrace(FormatString<Types...> Fmt, Types&&... Args)
+        {
+            LogFormat(DEFAULT_CATEGORY, Level::Trace, Fmt.format, Fmt.location, std::forward<Types>(Args)...);
+        }
+
+        template <class... Types>
+        static void LogDebug(FormatString<Types...> Fmt, Types&&... Args)
+        {
+            LogFormat(DEFAULT_CATEGORY, Level::Debug, Fmt.format, Fmt.location, std::forward<Types>(Args)...);
+        }
+
         template <class... Types>
-        static void LogInfo(std::format_string<Types...> Fmt, Types&&... Args)
+        static void LogInfo(FormatString<Types...> Fmt, Types&&... Args)
         {
-            LogInfo(std::format(Fmt, std::forward<Types>(Args)...));
+            LogFormat(DEFAULT_CATEGORY, Level::Info, Fmt.format, Fmt.location, std::forward<Types>(Args)...);
         }
 
         template <class... Types>
-        static void LogWarn(std::format_string<Types...> Fmt, Types&&... Args)
+        static void LogWarn(FormatString<Types...> Fmt, Types&&... Args)
         {
-            LogWarn(std::format(Fmt, std::forward<Types>(Args)...));
+            LogFormat(DEFAULT_CATEGORY, Level::Warning, Fmt.format, Fmt.location, std::forward<Types>(Args)...);
         }
 
         template <class... Types>
-        static void LogError(std::format_string<Types...> Fmt, Types&&... Args)
+        static void LogError(FormatString<Types...> Fmt, Types&&... Args)
         {
-            LogError(std::format(Fmt, std::forward<Types>(Args)...));
+            LogFormat(DEFAULT_CATEGORY, Level::Error, Fmt.format, Fmt.location, std::forward<Types>(Args)...);
         }
 #endif
 
+    public:
+        // Size of the argument storage in each async queue slot.
+        static constexpr size_t DEFERRED_ARGS_SIZE = 128;
+
+        // Messages formatted synchronously are cut to FORMAT_BUFFER_SIZE - 1 bytes, ending with the marker.
+        static constexpr size_t FORMAT_BUFFER_SIZE = INFRA_LOG_FORMAT_BUFFER_SIZE;
+        static constexpr std::string_view TRUNCATED_MARKER = "...[truncated]";
+
     private:
-        inline static Level _filterLevel = Level::Info;
+        using DeferredFormatFunc = void(*)(std::string_view format, void* pArgs, std::string& output);
+        using DeferredDestroyFunc = void(*)(void* pArgs);
+        using DeferredConstructFunc = void(*)(void* pArgs, void* pContext);
+        using FormatToBufferFunc = size_t(*)(char* pBuffer, size_t bufferSize, void* pContext);
+
+        struct DeferredFormat
+        {
+            std::string_view format;
+            DeferredFormatFunc pFormatFunc;
+            DeferredDestroyFunc pDestroyFunc;
+            DeferredConstructFunc pConstructFunc;
+        };
+
+        // Strings are owned by the copy, arithmetic and pointer values are copied as is.
+        // Other types may reference caller memory and are formatted eagerly.
+        template <typename T>
+        struct DeferredArg
+        {
+            using Decay = std::decay_t<T>;
+
+            static constexpr bool IS_STRING = std::is_same_v<Decay, char*> || std::is_same_v<Decay, const char*>
+                || std::is_same_v<Decay, std::string> || std::is_same_v<Decay, std::string_view>;
+
+            static constexpr bool VALID = IS_STRING || std::is_arithmetic_v<Decay> || std::is_null_pointer_v<Decay>
+                || std::is_same_v<Decay, void*> || std::is_same_v<Decay, const void*>;
+
+            using Type = std::conditional_t<IS_STRING, std::string, Decay>;
+        };
+
+        // Push deferred record into async queue, return false when async mode is off.
+        static bool TryEnqueueDeferred(const LogCategory& category, Level level, const std::source_location& location, const DeferredFormat& deferred, void* pContext);
+
+        static void LogMessage(const LogCategory& category, Level level, const std::source_location& location, const char* message);
+
+        // Format into the calling thread's buffer and log it, nothing is allocated.
+        static void LogFormatToBuffer(const LogCategory& category, Level level, const std::source_location& location, FormatToBufferFunc pFormatFunc, void* pContext);
+
+        static void AddCallBack(Level level, LogCallBack pFunc);
+        static void AddRecordCallBack(Level level, LogRecordCallBack pFunc);
+
+#if HAVE_STD_FORMAT
+        template <class Tuple>
+        static void FormatDeferred(std::string_view format, void* pArgs, std::string& output)
+        {
+            std::apply([&](auto&... args) -> void
+            {
+                output = std::vformat(format, std::make_format_args(args...));
+            }, *static_cast<Tuple*>(pArgs));
+        }
+
+        template <class Tuple>
+        static void DestroyDeferred(void* pArgs)
+        {
+            static_cast<Tuple*>(pArgs)->~Tuple();
+        }
+
+        template <class Tuple, class RefTuple>
+        static void ConstructDeferred(void* pArgs, void* pContext)
+        {
+            std::apply([&](auto&&... args) -> void
+            {
+                ::new (pArgs) Tuple(std::forward<decltype(args)>(args)...);
+            }, std::move(*static_cast<RefTuple*>(pContext)));
+        }
+
+        template <class... Types>
+        struct FormatContext
+        {
+            std::format_string<Types...> format;
+            std::tuple<Types&&...> args;
+        };
+
+        // Return the full formatted size, which may be larger than bufferSize.
+        template <class... Types>
+        static size_t FormatToBuffer(char* pBuffer, size_t bufferSize, void* pContext)
+        {
+            auto& context = *static_cast<FormatContext<Types...>*>(pContext);
+            return std::apply([&](auto&&... args) -> size_t
+            {
+                const auto result = std::format_to_n(pBuffer, static_cast<std::ptrdiff_t>(bufferSize), context.format, std::forward<decltype(args)>(args)...);
+                return static_cast<size_t>(result.size);
+            }, std::move(context.args));
+        }
+
+        template <class... Types>
+        static void LogFormat(const LogCategory& category, Level level, std::format_string<Types...> fmt, const std::source_location& location, Types&&... args)
+        {
+            if (!IsEnabled(category, level))
+                return;
+
+            using Tuple = std::tuple<typename DeferredArg<Types>::Type...>;
+            using RefTuple = std::tuple<Types&&...>;
+
+            if constexpr ((DeferredArg<Types>::VALID && ...)
+                && sizeof(Tuple) <= DEFERRED_ARGS_SIZE
+                && alignof(Tuple) <= alignof(std::max_align_t))
+            {
+                RefTuple refs(std::forward<Types>(args)...);
+                DeferredFormat deferred { fmt.get(), &FormatDeferred<Tuple>, &DestroyDeferred<Tuple>, &ConstructDeferred<Tuple, RefTuple> };
+                if (TryEnqueueDeferred(category, level, location, deferred, &refs))
+                    return;
+            }
+
+            FormatContext<Types...> context { fmt, std::tuple<Types&&...>(std::forward<Types>(args)...) };
+            LogFormatToBuffer(category, level, location, &FormatToBuffer<Types...>, &context);
+        }
+#endif
 
-        inline static std::vector<LogCallBack> _logInfoCallVec {};
-        inline static std::vector<LogCallBack> _logWarnCallVec {};
-        inline static std::vector<LogCallBack> _logErrorCallVec {};
+    private:
+        friend struct LoggerImpl;
+        friend class LogRateLimiter;
+
+        // Read the coarse clock into the cached timestamp and return it.
+        static int64_t RefreshCachedTimestamp();
+
+        // A rate limited site started suppressing, the background thread reports it once its window reopens.
+        static void WakeSuppressionReport();
+
+        struct CategoryLevel
+        {
+            std::atomic<Level> level = Level::Info;
+        };
+
+        // Effective level of each category, written only under the category level lock.
+        static CategoryLevel _categoryLevel[MAX_CATEGORY_COUNT];
+
+        static std::atomic<int64_t> _cachedTimestamp;
+    };
+
+    struct LogRecord
+    {
+        Logger::Level level;
+        const LogCategory* category;    // Never null, Logger::DEFAULT_CATEGORY for logs without a category
+        int64_t timestamp;              // Nanoseconds since unix epoch, see Logger::GetCoarseTimestamp
+        uint64_t threadId;              // Native id of the logging thread
+        std::source_location location;
+        std::string_view message;
+    };
+
+    // Registers a category during static initialization, see INFRA_LOG_CATEGORY.
+    struct LogCategoryRegistration
+    {
+        explicit LogCategoryRegistration(const LogCategory& category)
+        {
+            const bool registered = Logger::RegisterCategory(category);
+            ASSERT_MSG(registered, "Log category id is already used by another category");
+            (void)registered;
+        }
+    };
+
+    class LogSink
+    {
+    public:
+        virtual ~LogSink() = default;
+
+    public:
+        // Records are in log order, message views are only valid during the call.
+        virtual void OnBatch(std::span<const LogRecord> records) = 0;
+
+        // Called by Logger::Flush after pending records are delivered.
+        virtual void OnFlush() {}
+
+        // Called every few ten milliseconds from a background thread while the sink is added,
+        // for sinks buffering on their own to write out lines that waited too long.
+        virtual void OnTick(int64_t timestamp) { (void)timestamp; }
     };
 }
+
+#if INFRA_LOG_MIN_LEVEL <= INFRA_LOG_LEVEL_TRACE
+#   define INFRA_LOG_TRACE(...) do { if (::Infra::Logger::IsEnabled(::Infra::Logger::Level::Trace)) ::Infra::Logger::LogTrace(__VA_ARGS__); } while (0)
+#else
+#   define INFRA_LOG_TRACE(...) ((void)0)
+#endif
+
+#if INFRA_LOG_MIN_LEVEL <= INFRA_LOG_LEVEL_DEBUG
+#   define INFRA_LOG_DEBUG(...) do { if (::Infra::Logger::IsEnabled(::Infra::Logger::Level::Debug)) ::Infra::Logger::LogDebug(__VA_ARGS__); } while (0)
+#else
+#   define INFRA_LOG_DEBUG(...) ((void)0)
+#endif
+
+#if INFRA_LOG_MIN_LEVEL <= INFRA_LOG_LEVEL_INFO
+#   define INFRA_LOG_INFO(...) do { if (::Infra::Logger::IsEnabled(::Infra::Logger::Level::Info)) ::Infra::Logger::LogInfo(__VA_ARGS__); } while (0)
+#else
+#   define INFRA_LOG_INFO(...) ((void)0)
+#endif
+
+#if INFRA_LOG_MIN_LEVEL <= INFRA_LOG_LEVEL_WARNING
+#   define INFRA_LOG_WARN(...) do { if (::Infra::Logger::IsEnabled(::Infra::Logger::Level::Warning)) ::Infra::Logger::LogWarn(__VA_ARGS__); } while (0)
+#else
+#   define INFRA_LOG_WARN(...) ((void)0)
+#endif
+
+#if INFRA_LOG_MIN_LEVEL <= INFRA_LOG_LEVEL_ERROR
+#   define INFRA_LOG_ERROR(...) do { if (::Infra::Logger::IsEnabled(::Infra::Logger::Level::Error)) ::Infra::Logger::LogError(__VA_ARGS__); } while (0)
+#else
+#   define INFRA_LOG_ERROR(...) ((void)0)
+#endif
+
+// Declare a category at namespace scope, e.g. INFRA_LOG_CATEGORY(Network, 1). Ids must be unique,
+// a second category with the same id fails an assert when the program starts.
+#define INFRA_LOG_CATEGORY(categoryName, categoryId) \
+    static_assert((categoryId) > 0 && (categoryId) < ::Infra::Logger::MAX_CATEGORY_COUNT, "Log category id out of range"); \
+    inline constexpr ::Infra::LogCategory categoryName { (categoryId), #categoryName }; \
+    inline const ::Infra::LogCategoryRegistration categoryName##Registration { categoryName }
+
+// Log in category, level is a Logger::Level enumerator name, e.g. INFRA_LOG_CAT(Network, Debug, "...").
+#define INFRA_LOG_CAT(category, level, ...) \
+    do { if (::Infra::Logger::IsEnabled(category, ::Infra::Logger::Level::level)) ::Infra::Logger::Log(category, ::Infra::Logger::Level::level, __VA_ARGS__); } while (0)
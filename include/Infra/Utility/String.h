@@ -1,34 +1,92 @@
 #pragma once
 
-#include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <span>
 #include <ranges>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
 #include <algorithm>
 #include <optional>
+#include <charconv>
+#include <type_traits>
+#include <utility>
 
 namespace Infra
 {
+    template <typename Encoding>
+    class SplitRange;
+
     class String
     {
     public:
         String() = delete;
 
     public:
-        /// \brief Convert wide string to utf8 char string. Should set local before calling this.
+        /// \brief Convert wide string to utf8 char string. wchar_t is utf-16 on Windows and utf-32 elsewhere,
+        /// no locale is involved. Invalid code units become U+FFFD.
         static std::string WideStringToString(const std::wstring& wStr);
 
-        /// \brief Convert utf8 char string to wide string. Should set local before calling this.
+        /// \brief Convert utf8 char string to wide string, invalid bytes become U+FFFD.
         static std::wstring StringToWideString(const std::string& str);
 
+        /// \brief Strict utf conversions, std::nullopt when the input has an invalid sequence,
+        /// whose offset in input code units is stored to \p pErrorOffset if it is not null.
+        static std::optional<std::u16string> Utf8ToUtf16(std::string_view str, size_t* pErrorOffset = nullptr);
+        static std::optional<std::u32string> Utf8ToUtf32(std::string_view str, size_t* pErrorOffset = nullptr);
+        static std::optional<std::string> Utf16ToUtf8(std::u16string_view str, size_t* pErrorOffset = nullptr);
+        static std::optional<std::string> Utf32ToUtf8(std::u32string_view str, size_t* pErrorOffset = nullptr);
+
+        /// \brief Check \p str is well formed utf-8, the offset of the first invalid sequence is stored to
+        /// \p pErrorOffset if it is not null. Uses AVX2 lookup tables when the cpu has them.
+        static bool ValidateUtf8(std::string_view str, size_t* pErrorOffset = nullptr);
+
+        /// \brief Number of code points in utf-8 \p str, counted as the bytes that are not continuation
+        /// bytes, so the input is expected to be valid. Uses SSE2/AVX2 when the cpu has them.
+        static size_t CountCodePoints(std::string_view str);
+
+        /// \brief First \p target in [begin, end), end if there is none. Uses SSE2/AVX2 when the cpu has them.
+        static const char* FindByte(const char* begin, const char* end, char target);
+
+        /// \brief Number of \p target in [begin, end). Uses SSE2/AVX2 when the cpu has them.
+        static size_t CountByte(const char* begin, const char* end, char target);
+
+        /// \brief Substring search over any byte buffer, e.g. a loaded file wrapped in a string_view.
+        /// Candidates are filtered on the first and last needle byte with SSE2/AVX2 and then compared.
+        /// Find returns npos when there is no match and \p pos for an empty needle, like std::string::find.
+        static size_t Find(std::string_view haystack, std::string_view needle, size_t pos = 0);
+        static bool Contains(std::string_view haystack, std::string_view needle);
+
+        /// \brief Non-overlapping matches scanned from the left, an empty needle has none.
+        static size_t Count(std::string_view haystack, std::string_view needle);
+        static std::vector<size_t> FindAll(std::string_view haystack, std::string_view needle);
+
+        /// \brief Leftmost match of any of \p needles, the longest one when several start there.
+        /// The index of the matched needle is stored to \p pNeedleIndex if it is not null,
+        /// empty needles are ignored. Returns npos when none matches.
+        static size_t FindAny(std::string_view haystack, std::span<const std::string_view> needles, size_t* pNeedleIndex = nullptr);
+
         template <typename Encoding, typename DelimType>
         static std::vector<std::basic_string_view<Encoding>> SplitView(const std::basic_string<Encoding>& inputStr, DelimType delim)
         {
-            auto split = std::views::split(inputStr, delim);
+            return SplitView(std::basic_string_view<Encoding>(inputStr), delim);
+        }
 
+        template <typename Encoding, typename DelimType>
+        static std::vector<std::basic_string_view<Encoding>> SplitView(std::basic_string_view<Encoding> inputStr, DelimType delim)
+        {
             std::vector<std::basic_string_view<Encoding>> result;
-            for (const auto& element : split)
-                result.emplace_back(element.begin(), element.end());
+
+            if constexpr (IS_BYTE_DELIMITER<Encoding, DelimType>)
+                SplitByte(inputStr, delim, result);
+            else
+            {
+                for (const auto& element : std::views::split(inputStr, delim))
+                    result.emplace_back(element.begin(), element.end());
+            }
 
             return result;
         }
@@ -36,64 +94,483 @@ namespace Infra
         template <typename Encoding, typename DelimType>
         static std::vector<std::basic_string<Encoding>> Split(const std::basic_string<Encoding>& inputStr, DelimType delim)
         {
-            auto split = std::views::split(inputStr, delim);
-
             std::vector<std::basic_string<Encoding>> result;
-            for (const auto& element : split)
-                result.emplace_back(element.begin(), element.end());
+
+            if constexpr (IS_BYTE_DELIMITER<Encoding, DelimType>)
+                SplitByte(inputStr, delim, result);
+            else
+            {
+                for (const auto& element : std::views::split(inputStr, delim))
+                    result.emplace_back(element.begin(), element.end());
+            }
 
             return result;
         }
 
+        /// \brief Lazy split, pieces are found while iterating and view into \p inputStr, which must outlive the range.
+        /// At most \p maxPieces are produced, the last one holds the rest of the input unsplit.
         template <typename Encoding>
-        static std::basic_string<Encoding> Join(const std::vector<std::basic_string<Encoding>>& strVec, const std::basic_string<Encoding>& delim)
+        static SplitRange<Encoding> SplitLazy(std::type_identity_t<std::basic_string_view<Encoding>> inputStr, Encoding delim, size_t maxPieces = SIZE_MAX)
+        {
+            return SplitRange<Encoding>(inputStr, delim, maxPieces);
+        }
+
+        /// \brief Join any range of strings, string_views or C strings. \p delim is a string-like value or one character.
+        /// Output size is computed first, the result is allocated once.
+        template <std::ranges::forward_range Range, typename DelimType>
+        static auto Join(const Range& strRange, const DelimType& delim)
         {
-            std::basic_ostringstream<Encoding> oss;
+            using Encoding = StringEncoding<std::ranges::range_reference_t<const Range>>;
+
+            const std::basic_string_view<Encoding> delimView = ToStringView<Encoding>(delim);
 
-            for (auto itr = strVec.begin(); itr != strVec.end(); ++itr)
+            size_t size = 0;
+            size_t count = 0;
+            for (const auto& element : strRange)
             {
-                oss << *itr;
-                if (itr != strVec.end() - 1)
-                    oss << delim;
+                size += ToStringView<Encoding>(element).size();
+                count++;
             }
 
-            return oss.str();
+            std::basic_string<Encoding> result;
+            if (count == 0)
+                return result;
+
+            result.reserve(size + delimView.size() * (count - 1));
+
+            bool first = true;
+            for (const auto& element : strRange)
+            {
+                if (!first)
+                    result.append(delimView);
+
+                result.append(ToStringView<Encoding>(element));
+                first = false;
+            }
+
+            return result;
+        }
+
+        /// \brief Character type of a string-like type, char for std::string, const char* or char[N].
+        template <typename T>
+        using StringEncoding = std::remove_cvref_t<decltype(std::declval<T>()[0])>;
+
+        /// \brief View of a string-like value, a single character becomes a view of size one.
+        template <typename Encoding, typename T>
+        static std::basic_string_view<Encoding> ToStringView(const T& value)
+        {
+            if constexpr (std::is_same_v<T, Encoding>)
+                return std::basic_string_view<Encoding>(&value, 1);
+            else
+                return std::basic_string_view<Encoding>(value);
         }
 
         template <typename Encoding>
         static void Replace(std::basic_string<Encoding>& inStr, const std::basic_string<Encoding>& from, const std::basic_string<Encoding>& to)
         {
-            size_t startPos = 0;
-            while ((startPos = inStr.find(from, startPos)) != std::string::npos)
+            if (from.empty())
+                return;
+
+            // Same length needs no moving, overwrite in place.
+            if (from.size() == to.size())
             {
-                inStr.replace(startPos, from.length(), to);
-                startPos += to.length();
+                size_t startPos = 0;
+                while ((startPos = inStr.find(from, startPos)) != std::basic_string<Encoding>::npos)
+                {
+                    std::copy(to.begin(), to.end(), inStr.begin() + static_cast<std::ptrdiff_t>(startPos));
+                    startPos += to.size();
+                }
+
+                return;
             }
+
+            inStr = ReplaceCopy<Encoding>(inStr, from, to);
         }
 
+        /// \brief Copy of \p inStr with every non-overlapping \p from replaced by \p to, left to right.
+        /// Matches are found in one scan and the result is allocated once.
         template <typename Encoding>
-        static void TrimStart(std::basic_string<Encoding>& str)
+        static std::basic_string<Encoding> ReplaceCopy(std::type_identity_t<std::basic_string_view<Encoding>> inStr,
+            std::type_identity_t<std::basic_string_view<Encoding>> from, std::type_identity_t<std::basic_string_view<Encoding>> to)
         {
-            str.erase(str.begin(), std::find_if(str.begin(), str.end(), [](Encoding ch)
+            if (from.empty())
+                return std::basic_string<Encoding>(inStr);
+
+            std::vector<size_t> matchVec;
+            for (size_t pos = inStr.find(from); pos != std::basic_string_view<Encoding>::npos; pos = inStr.find(from, pos + from.size()))
+                matchVec.push_back(pos);
+
+            std::basic_string<Encoding> result;
+            result.reserve(inStr.size() - matchVec.size() * from.size() + matchVec.size() * to.size());
+
+            size_t copyPos = 0;
+            for (const size_t matchPos : matchVec)
             {
-                return !std::isspace(static_cast<int>(ch));
-            }));
+                result.append(inStr.substr(copyPos, matchPos - copyPos));
+                result.append(to);
+                copyPos = matchPos + from.size();
+            }
+
+            result.append(inStr.substr(copyPos));
+            return result;
+        }
+
+        /// \brief Replace many patterns in one scan, see StringReplacer. Build a StringReplacer
+        /// directly when the same pairs are applied to many inputs.
+        static std::string ReplaceAll(std::string_view inStr, const std::vector<std::pair<std::string, std::string>>& pairs);
+
+        /// \brief ' ', '\t', '\n', '\v', '\f' and '\r', what std::isspace accepts in the "C" locale,
+        /// without depending on the current locale.
+        template <typename Encoding>
+        static constexpr bool IsAsciiSpace(Encoding ch)
+        {
+            return ch == static_cast<Encoding>(' ') || (ch >= static_cast<Encoding>('\t') && ch <= static_cast<Encoding>('\r'));
+        }
+
+        template <typename Encoding>
+        static void TrimStart(std::basic_string<Encoding>& str)
+        {
+            str.erase(0, str.size() - TrimStartView(str).size());
         }
 
         template <typename Encoding>
         static void TrimEnd(std::basic_string<Encoding>& str)
         {
-            str.erase(std::find_if(str.rbegin(), str.rend(), [](Encoding ch)
-            {
-                return !std::isspace(static_cast<int>(ch));
-            }).base(), str.end());
+            str.resize(TrimEndView(str).size());
         }
 
         template <typename Encoding>
         static void Trim(std::basic_string<Encoding>& str)
         {
-            TrimStart(str);
             TrimEnd(str);
+            TrimStart(str);
+        }
+
+        /// \brief Views of \p str without leading and/or trailing ascii whitespace, nothing is copied.
+        template <typename T>
+        static std::basic_string_view<StringEncoding<T>> TrimStartView(const T& str)
+        {
+            const std::basic_string_view<StringEncoding<T>> view = ToStringView<StringEncoding<T>>(str);
+
+            size_t begin = 0;
+            while (begin < view.size() && IsAsciiSpace(view[begin]))
+                begin++;
+
+            return view.substr(begin);
+        }
+
+        template <typename T>
+        static std::basic_string_view<StringEncoding<T>> TrimEndView(const T& str)
+        {
+            const std::basic_string_view<StringEncoding<T>> view = ToStringView<StringEncoding<T>>(str);
+
+            size_t end = view.size();
+            while (end > 0 && IsAsciiSpace(view[end - 1]))
+                end--;
+
+            return view.substr(0, end);
+        }
+
+        template <typename T>
+        static std::basic_string_view<StringEncoding<T>> TrimView(const T& str)
+        {
+            return TrimStartView(TrimEndView(str));
+        }
+
+        /// \brief Ascii case conversion in place, other bytes including utf-8 sequences are kept.
+        /// 16 bytes per step with SSE2 on x86-64, 8 bytes per step elsewhere.
+        static void ToLower(std::string& str);
+        static void ToUpper(std::string& str);
+
+        /// \brief Equality and hash that ignore ascii case, so the pair can key an unordered
+        /// container with case-insensitive lookup, see IgnoreCaseHash and IgnoreCaseEqual.
+        static bool EqualsIgnoreCase(std::string_view lhs, std::string_view rhs);
+        static size_t HashIgnoreCase(std::string_view str);
+
+        struct IgnoreCaseHash
+        {
+            using is_transparent = void;
+
+            size_t operator()(std::string_view str) const
+            {
+                return HashIgnoreCase(str);
+            }
+        };
+
+        struct IgnoreCaseEqual
+        {
+            using is_transparent = void;
+
+            bool operator()(std::string_view lhs, std::string_view rhs) const
+            {
+                return EqualsIgnoreCase(lhs, rhs);
+            }
+        };
+
+        enum class ParseError: int
+        {
+            None = 0,
+            Empty = 1,              // Nothing to parse
+            InvalidCharacter = 2,   // No number at the error offset, or characters left after it
+            OutOfRange = 3          // A number that does not fit the type
+        };
+
+        /// \brief Longest ToChars output of any arithmetic type.
+        static constexpr size_t TO_CHARS_BUFFER_SIZE = 64;
+
+        /// \brief Parse the whole of \p str as an integer or floating point number with std::from_chars,
+        /// no locale, whitespace or exception is involved. A leading '+' is accepted. On failure the
+        /// error and the offset it was found at are stored to \p pError and \p pErrorOffset if not null.
+        template <typename T>
+            requires std::is_arithmetic_v<T> && (!std::is_same_v<T, bool>)
+        static std::optional<T> Parse(std::string_view str, ParseError* pError = nullptr, size_t* pErrorOffset = nullptr)
+        {
+            const auto Fail = [pError, pErrorOffset](ParseError error, size_t offset) -> std::optional<T>
+            {
+                if (pError != nullptr)
+                    *pError = error;
+
+                if (pErrorOffset != nullptr)
+                    *pErrorOffset = offset;
+
+                return std::nullopt;
+            };
+
+            if (str.empty())
+                return Fail(ParseError::Empty, 0);
+
+            // from_chars rejects '+', skipping it must not let "+-1" through.
+            size_t begin = 0;
+            if (str[0] == '+' && str.size() > 1 && str[1] != '-')
+                begin = 1;
+
+            T value{};
+            const char* pEnd = str.data() + str.size();
+            const auto [pStop, errorCode] = std::from_chars(str.data() + begin, pEnd, value);
+            const auto stopOffset = static_cast<size_t>(pStop - str.data());
+
+            if (errorCode == std::errc::result_out_of_range)
+                return Fail(ParseError::OutOfRange, begin);
+
+            if (errorCode != std::errc() || pStop != pEnd)
+                return Fail(ParseError::InvalidCharacter, stopOffset);
+
+            return value;
+        }
+
+        /// \brief Parse a column of fields, e.g. one column of a csv file. Integer fields of plain digits
+        /// are converted eight digits per step inside a 64 bit word, everything else goes through Parse.
+        /// On failure \p output holds the values before the failing field, whose index is stored to
+        /// \p pErrorIndex if it is not null.
+        template <typename T>
+            requires std::is_arithmetic_v<T> && (!std::is_same_v<T, bool>)
+        static bool ParseColumn(std::span<const std::string_view> fields, std::vector<T>& output, size_t* pErrorIndex = nullptr)
+        {
+            output.clear();
+            output.reserve(fields.size());
+
+            for (size_t i = 0; i < fields.size(); i++)
+            {
+                if constexpr (std::is_integral_v<T>)
+                {
+                    std::string_view digits = fields[i];
+                    const bool negative = !digits.empty() && digits[0] == '-';
+                    if (negative || (!digits.empty() && digits[0] == '+'))
+                        digits.remove_prefix(1);
+
+                    // The magnitude of the most negative value is one past the maximum.
+                    uint64_t magnitude;
+                    const auto limit = static_cast<uint64_t>(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+                    if ((!negative || std::is_signed_v<T>) && ParseDigits(digits, magnitude) && magnitude <= limit)
+                    {
+                        output.push_back(negative ? static_cast<T>(0 - magnitude) : static_cast<T>(magnitude));
+                        continue;
+                    }
+                }
+
+                const std::optional<T> value = Parse<T>(fields[i]);
+                if (!value.has_value())
+                {
+                    if (pErrorIndex != nullptr)
+                        *pErrorIndex = i;
+
+                    return false;
+                }
+
+                output.push_back(*value);
+            }
+
+            return true;
+        }
+
+        /// \brief Format \p value with std::to_chars into \p buffer, the shortest round trip form for
+        /// floating point. Returns the written part of \p buffer, empty when it is too small.
+        template <typename T>
+            requires std::is_arithmetic_v<T> && (!std::is_same_v<T, bool>)
+        static std::string_view ToChars(T value, std::span<char> buffer)
+        {
+            const auto [pEnd, errorCode] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+            if (errorCode != std::errc())
+                return {};
+
+            return { buffer.data(), static_cast<size_t>(pEnd - buffer.data()) };
+        }
+
+    private:
+        template <typename Encoding, typename DelimType>
+        static constexpr bool IS_BYTE_DELIMITER = std::is_same_v<Encoding, char> && std::is_same_v<std::remove_cvref_t<DelimType>, char>;
+
+        // Plain decimal digits, at most 19 of them so the value fits uint64_t.
+        static bool ParseDigits(std::string_view digits, uint64_t& value);
+
+        // Same pieces as std::views::split: none for empty input, a trailing delimiter gives a trailing empty piece.
+        template <typename Container>
+        static void SplitByte(std::string_view inputStr, char delim, Container& result)
+        {
+            if (inputStr.empty())
+                return;
+
+            const char* pBegin = inputStr.data();
+            const char* pEnd = pBegin + inputStr.size();
+
+            // Counting first is a cheap vector pass and saves every reallocation on large inputs.
+            result.reserve(CountByte(pBegin, pEnd, delim) + 1);
+            while (true)
+            {
+                const char* pFound = FindByte(pBegin, pEnd, delim);
+                result.emplace_back(pBegin, pFound);
+                if (pFound == pEnd)
+                    break;
+
+                pBegin = pFound + 1;
+            }
+        }
+    };
+
+    /* Forward range over the pieces of a string_view split by one delimiter, nothing is allocated
+     * and iteration can stop at any piece. Pieces are the same as String::SplitView, except that
+     * with maxPieces the last piece is the unsplit rest of the input.
+     */
+    template <typename Encoding>
+    class SplitRange
+    {
+    public:
+        class Iterator
+        {
+        public:
+            using value_type = std::basic_string_view<Encoding>;
+            using difference_type = std::ptrdiff_t;
+            using iterator_concept = std::forward_iterator_tag;
+
+        public:
+            Iterator() = default;
+
+            Iterator(std::basic_string_view<Encoding> inputStr, Encoding delim, size_t maxPieces)
+                : _rest(inputStr)
+                , _delim(delim)
+                , _piecesLeft(maxPieces)
+                , _hasRest(!inputStr.empty() && maxPieces > 0)
+                , _atEnd(false)
+            {
+                Advance();
+            }
+
+            value_type operator*() const
+            {
+                return _current;
+            }
+
+            Iterator& operator++()
+            {
+                Advance();
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                Iterator old = *this;
+                Advance();
+                return old;
+            }
+
+            friend bool operator==(const Iterator& left, const Iterator& right)
+            {
+                if (left._atEnd || right._atEnd)
+                    return left._atEnd == right._atEnd;
+
+                return left._current.data() == right._current.data() && left._current.size() == right._current.size();
+            }
+
+            friend bool operator==(const Iterator& iterator, std::default_sentinel_t)
+            {
+                return iterator._atEnd;
+            }
+
+        private:
+            void Advance()
+            {
+                if (!_hasRest)
+                {
+                    _atEnd = true;
+                    return;
+                }
+
+                _piecesLeft--;
+                const size_t pos = _piecesLeft == 0 ? std::basic_string_view<Encoding>::npos : Find();
+                if (pos == std::basic_string_view<Encoding>::npos)
+                {
+                    _current = _rest;
+                    _rest = {};
+                    _hasRest = false;
+                    return;
+                }
+
+                _current = _rest.substr(0, pos);
+                _rest.remove_prefix(pos + 1);
+            }
+
+            size_t Find() const
+            {
+                if constexpr (std::is_same_v<Encoding, char>)
+                {
+                    const char* pEnd = _rest.data() + _rest.size();
+                    const char* pFound = String::FindByte(_rest.data(), pEnd, _delim);
+                    return pFound == pEnd ? std::string_view::npos : static_cast<size_t>(pFound - _rest.data());
+                }
+                else
+                    return _rest.find(_delim);
+            }
+
+        private:
+            std::basic_string_view<Encoding> _current {};
+            std::basic_string_view<Encoding> _rest {};
+            Encoding _delim {};
+            size_t _piecesLeft = 0;
+            bool _hasRest = false;
+            bool _atEnd = true;
+        };
+
+    public:
+        SplitRange(std::basic_string_view<Encoding> inputStr, Encoding delim, size_t maxPieces = SIZE_MAX)
+            : _inputStr(inputStr)
+            , _delim(delim)
+            , _maxPieces(maxPieces)
+        {
+        }
+
+        Iterator begin() const
+        {
+            return Iterator(_inputStr, _delim, _maxPieces);
         }
+
+        std::default_sentinel_t end() const
+        {
+            return std::default_sentinel;
+        }
+
+    private:
+        std::basic_string_view<Encoding> _inputStr;
+        Encoding _delim;
+        size_t _maxPieces;
     };
 }
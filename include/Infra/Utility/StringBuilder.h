@@ -0,0 +1,146 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <type_traits>
+#include "String.h"
+
+namespace Infra
+{
+    /* Appends into one growing string, every append returns the builder so calls can be chained.
+     * Numbers are written with std::to_chars, no locale or stream is involved.
+     */
+    template <typename Encoding>
+    class BasicStringBuilder
+    {
+    private:
+        // Character types are appended as characters, not as their code.
+        template <typename T>
+        static constexpr bool IS_NUMBER = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>
+            && !std::is_same_v<T, char> && !std::is_same_v<T, wchar_t> && !std::is_same_v<T, char8_t>
+            && !std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t>;
+
+    public:
+        BasicStringBuilder() = default;
+
+        explicit BasicStringBuilder(size_t capacity)
+        {
+            _buffer.reserve(capacity);
+        }
+
+    public:
+        BasicStringBuilder& Reserve(size_t capacity)
+        {
+            _buffer.reserve(capacity);
+            return *this;
+        }
+
+        BasicStringBuilder& Append(std::basic_string_view<Encoding> str)
+        {
+            _buffer.append(str);
+            return *this;
+        }
+
+        BasicStringBuilder& Append(const Encoding* str)
+        {
+            _buffer.append(str);
+            return *this;
+        }
+
+        BasicStringBuilder& Append(const std::basic_string<Encoding>& str)
+        {
+            _buffer.append(str);
+            return *this;
+        }
+
+        BasicStringBuilder& Append(Encoding ch)
+        {
+            _buffer.push_back(ch);
+            return *this;
+        }
+
+        BasicStringBuilder& Append(Encoding ch, size_t count)
+        {
+            _buffer.append(count, ch);
+            return *this;
+        }
+
+        template <typename T>
+            requires IS_NUMBER<T>
+        BasicStringBuilder& Append(T value)
+        {
+            char buffer[String::TO_CHARS_BUFFER_SIZE];
+            const std::string_view digits = String::ToChars(value, buffer);
+
+            if constexpr (std::is_same_v<Encoding, char>)
+                _buffer.append(digits);
+            else
+                _buffer.append(digits.begin(), digits.end());
+
+            return *this;
+        }
+
+        BasicStringBuilder& AppendLine(std::basic_string_view<Encoding> str = {})
+        {
+            _buffer.append(str);
+            _buffer.push_back(static_cast<Encoding>('\n'));
+            return *this;
+        }
+
+        template <std::ranges::forward_range Range, typename DelimType>
+        BasicStringBuilder& AppendJoin(const Range& strRange, const DelimType& delim)
+        {
+            const std::basic_string_view<Encoding> delimView = String::ToStringView<Encoding>(delim);
+
+            bool first = true;
+            for (const auto& element : strRange)
+            {
+                if (!first)
+                    _buffer.append(delimView);
+
+                _buffer.append(String::ToStringView<Encoding>(element));
+                first = false;
+            }
+
+            return *this;
+        }
+
+        size_t Size() const
+        {
+            return _buffer.size();
+        }
+
+        bool Empty() const
+        {
+            return _buffer.empty();
+        }
+
+        void Clear()
+        {
+            _buffer.clear();
+        }
+
+        std::basic_string_view<Encoding> View() const
+        {
+            return _buffer;
+        }
+
+        std::basic_string<Encoding> ToString() const &
+        {
+            return _buffer;
+        }
+
+        /// \brief Move the result out, the builder is empty afterwards.
+        std::basic_string<Encoding> ToString() &&
+        {
+            return std::exchange(_buffer, {});
+        }
+
+    private:
+        std::basic_string<Encoding> _buffer;
+    };
+
+    using StringBuilder = BasicStringBuilder<char>;
+    using WideStringBuilder = BasicStringBuilder<wchar_t>;
+}
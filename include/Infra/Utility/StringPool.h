@@ -0,0 +1,88 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ranges>
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include "Hash.h"
+#include "String.h"
+#include "NonCopyable.h"
+
+namespace Infra
+{
+    /* Interns strings: every distinct string is copied once into an arena and gets a dense id,
+     * so interned strings are compared and hashed as integers. Ids start at 0 in interning order
+     * and views returned by GetView stay valid until the pool is destroyed.
+     *
+     * With threadSafe set, lookups of strings already interned take a shared lock and only new
+     * strings take the exclusive one. Without it the pool must not be used from several threads.
+     */
+    class StringPool : public NonCopyable
+    {
+    public:
+        using Id = uint32_t;
+
+        struct Config
+        {
+            bool threadSafe = false;
+            size_t blockSize = 64 * 1024;   // Arena block, longer strings get a block of their own
+        };
+
+    public:
+        StringPool();
+        explicit StringPool(const Config& config);
+
+    public:
+        Id Intern(std::string_view str);
+
+        /// \brief Intern every element of \p strRange under one lock, ids are in range order.
+        template <std::ranges::forward_range Range>
+        std::vector<Id> InternBulk(const Range& strRange)
+        {
+            std::vector<std::string_view> views;
+            if constexpr (std::ranges::sized_range<Range>)
+                views.reserve(std::ranges::size(strRange));
+
+            for (const auto& element : strRange)
+                views.push_back(String::ToStringView<char>(element));
+
+            std::vector<Id> ids(views.size());
+            InternViews(views.data(), views.size(), ids.data());
+            return ids;
+        }
+
+        /// \brief Id of \p str if it was interned, the pool is not changed.
+        std::optional<Id> Find(std::string_view str) const;
+
+        /// \brief \p id must come from this pool.
+        std::string_view GetView(Id id) const;
+
+        size_t Size() const;
+
+        /// \brief Bytes held by arena blocks.
+        size_t GetArenaSize() const;
+
+    private:
+        Id InternLocked(std::string_view str);
+        void InternViews(const std::string_view* pViews, size_t count, Id* pIds);
+        std::string_view CopyToArena(std::string_view str);
+
+    private:
+        Config _config;
+        mutable std::shared_mutex _mutex;
+
+        std::vector<std::unique_ptr<char[]>> _blocks;
+        char* _pBlockCurrent;
+        size_t _blockRemain;
+        size_t _arenaSize;
+
+        // Keys point into the arena, so the map never owns string memory.
+        std::vector<std::string_view> _views;
+        std::unordered_map<std::string_view, Id, StringHash> _idMap;
+    };
+}
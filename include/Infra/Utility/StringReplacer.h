@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <optional>
+
+namespace Infra
+{
+    /* Replaces many patterns in one scan with an Aho-Corasick automaton. Matching is leftmost
+     * longest and non-overlapping: at the leftmost position where any pattern matches, the
+     * longest one is replaced and scanning continues after it. Build once, apply to any number
+     * of inputs, Replace is const and can be called from several threads.
+     *
+     * The automaton is a dense table over the byte classes that occur in the patterns, every
+     * other byte shares one class, so a node takes (distinct pattern bytes + 4) words. When no
+     * match is pending the scan jumps straight to the next byte that starts a pattern.
+     */
+    class StringReplacer
+    {
+    public:
+        using Pair = std::pair<std::string, std::string>;
+
+    public:
+        /// \brief Empty patterns are ignored, for duplicated patterns the first pair wins.
+        explicit StringReplacer(const std::vector<Pair>& pairs);
+
+    public:
+        std::string Replace(std::string_view inStr) const;
+
+        /// \brief Append the replaced \p inStr to \p output.
+        void Replace(std::string_view inStr, std::string& output) const;
+
+        size_t GetPatternCount() const;
+
+    private:
+        struct Match
+        {
+            size_t position;
+            uint32_t pattern;
+        };
+
+        static constexpr uint32_t NO_PATTERN = UINT32_MAX;
+
+        // Row layout of a node in _table, the transitions follow the header.
+        static constexpr uint32_t ROW_DEPTH = 0;
+        static constexpr uint32_t ROW_PATTERN = 1;     // Pattern ending exactly at this node
+        static constexpr uint32_t ROW_OUTPUT = 2;      // Nearest node on the failure chain that ends a pattern
+        static constexpr uint32_t ROW_HEADER_SIZE = 3;
+
+        uint32_t AddNode(uint32_t depth);
+        void Build();
+        size_t SkipToStartByte(std::string_view inStr, size_t pos) const;
+        void FindMatches(std::string_view inStr, std::vector<Match>& matchVec) const;
+
+    private:
+        std::vector<Pair> _pairs;
+        uint16_t _byteClass[256];               // Offset of the byte's transition inside a row
+        uint32_t _rowSize;
+        bool _startByte[256];                   // First bytes of patterns
+        std::optional<char> _singleStartByte;   // Set when all patterns start with the same byte
+
+        // Nodes are identified by the offset of their row, so a transition is a single load.
+        std::vector<uint32_t> _table;
+    };
+}
@@ -2,10 +2,11 @@
 
 namespace Infra
 {
-    static std::optional<std::string> GetFullName(const std::string& input)
+    // View into input, looked up in the option map without a copy.
+    static std::optional<std::string_view> GetFullName(const std::string& input)
     {
         if (input.size() > 2 && input[0] == '-' && input[1] == '-')
-            return input.substr(2);
+            return std::string_view(input).substr(2);
 
         return std::nullopt;
     }
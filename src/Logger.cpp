@@ -1,86 +1,1571 @@
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <bitset>
+#include <condition_variable>
 #include "Infra/Utility/Logger.h"
+#include "Infra/Utility/LogSampling.h"
+#include "Infra/Utility/NonCopyable.h"
+#include "Infra/Utility/ScopeGuard.h"
+#include "Logger/RingQueue.hpp"
+#include "Logger/LogPlatform.hpp"
+#include "Logger/LogFlightRecorder.hpp"
 
-static std::mutex gMutex = {};
+namespace Infra
+{
+    // Queue slot, holds either a formatted message or deferred format arguments.
+    struct AsyncLogEntry
+    {
+        LogRecord record;
+        std::string message;
+        std::string_view format;
+        void (*pFormatFunc)(std::string_view format, void* pArgs, std::string& output) = nullptr;
+        void (*pDestroyFunc)(void* pArgs) = nullptr;
+        alignas(std::max_align_t) unsigned char args[Logger::DEFERRED_ARGS_SIZE];
+    };
+
+    // Formatted record moved out of the queue by the worker.
+    struct AsyncDrainedEntry
+    {
+        LogRecord record;
+        std::string message;
+    };
+
+    using AsyncLogQueue = RingQueue<AsyncLogEntry>;
+
+    static constexpr size_t ASYNC_DRAIN_BATCH_SIZE = 256;
+    static constexpr auto ASYNC_WORKER_IDLE_WAIT = std::chrono::milliseconds(10);
+
+    // Immutable snapshot of callbacks and sinks, writers publish a new copy.
+    struct SinkTable
+    {
+        std::vector<Logger::LogCallBack> callVec[Logger::LEVEL_COUNT];
+        std::vector<Logger::LogRecordCallBack> recordCallVec[Logger::LEVEL_COUNT];
+        std::vector<std::shared_ptr<LogSink>> sinkVec;
+    };
+
+    // gSinkTable is only read or replaced under gSinkTableMutex, readers go through SinkTableReader.
+    static std::mutex gSinkTableMutex = {};
+    static std::shared_ptr<const SinkTable> gSinkTable = std::make_shared<SinkTable>();
+    static std::atomic<uint64_t> gSinkTableVersion = 1;
+
+    // Global filter level, categories without an override follow it. Guarded by gCategoryLevelMutex for writes.
+    static std::mutex gCategoryLevelMutex = {};
+    static std::atomic<Logger::Level> gFilterLevel = Logger::Level::Info;
+    static std::bitset<Logger::MAX_CATEGORY_COUNT> gCategoryLevelOverridden;
+
+    // Owner of each category id, filled during static initialization so it is constant initialized.
+    static const LogCategory* gRegisteredCategories[Logger::MAX_CATEGORY_COUNT] = { &Logger::DEFAULT_CATEGORY };
+
+    constinit Logger::CategoryLevel Logger::_categoryLevel[Logger::MAX_CATEGORY_COUNT];
+    constinit std::atomic<int64_t> Logger::_cachedTimestamp = 0;
+
+    // Sync mode staging config.
+    static std::atomic<size_t> gStagingRecordCount = Logger::BatchConfig{}.stagingRecordCount;
+    static std::atomic<size_t> gStagingBufferSize = Logger::BatchConfig{}.stagingBufferSize;
+    static std::atomic<uint32_t> gMaxStagingDelayMs = Logger::BatchConfig{}.maxStagingDelayMs;
+
+    // Async state, start/stop is serialized by gAsyncControlMutex.
+    static std::mutex gAsyncControlMutex = {};
+    static std::atomic<AsyncLogQueue*> gAsyncQueue = nullptr;
+    static std::unique_ptr<AsyncLogQueue> gAsyncQueueStorage = nullptr;
+    static std::vector<std::unique_ptr<AsyncLogQueue>> gAsyncRetiredQueues;
+    static std::atomic<Logger::OverflowPolicy> gAsyncOverflowPolicy = Logger::OverflowPolicy::Block;
+    static std::atomic<bool> gAsyncRunning = false;
+    static std::atomic<size_t> gAsyncDeliveredPos = 0;
+    static std::thread gAsyncWorker;
+
+    // Set on the worker, only it frees queue slots so it must never wait for one.
+    static thread_local bool tAsyncWorker = false;
+
+    // Worker wake up, producers only touch the condition variable when worker sleeps.
+    static std::mutex gAsyncWakeMutex = {};
+    static std::condition_variable gAsyncWakeCondition;
+    static std::atomic<bool> gAsyncWorkerSleeping = false;
+
+    // Flight recorder, replaced recorders are kept mapped since a logging thread may still write to them.
+    static std::mutex gFlightRecorderMutex = {};
+    static std::atomic<LogFlightRecorder*> gFlightRecorder = nullptr;
+    static std::unique_ptr<LogFlightRecorder> gFlightRecorderStorage = nullptr;
+    static std::vector<std::unique_ptr<LogFlightRecorder>> gRetiredFlightRecorders;
+
+    // Overflow counters, only touched when the queue is full.
+    static std::atomic<uint64_t> gAsyncBlockedCount = 0;
+    static std::atomic<uint64_t> gAsyncDroppedNewestCount = 0;
+    static std::atomic<uint64_t> gAsyncDroppedOldestCount = 0;
+    static std::atomic<size_t> gAsyncQueueHighWaterMark = 0;
+
+    /* Per-level counters, each thread owns a shard so counting is a plain load and store
+     * without a locked instruction or a shared cache line. Shards of exited threads are
+     * folded into gRetiredStatistics.
+     */
+    struct alignas(64) StatisticsShard
+    {
+        std::atomic<uint64_t> accepted[Logger::LEVEL_COUNT];
+        std::atomic<uint64_t> dropped[Logger::LEVEL_COUNT];
+        std::atomic<uint64_t> bytes[Logger::LEVEL_COUNT];
+    };
+
+    static std::mutex gStatisticsMutex = {};
+    static std::vector<const StatisticsShard*> gStatisticsShards;
+    static Logger::LevelStatistics gRetiredStatistics[Logger::LEVEL_COUNT];
+
+    static void AddStatistics(const StatisticsShard& shard, Logger::LevelStatistics* pLevels)
+    {
+        for (int i = 0; i < Logger::LEVEL_COUNT; i++)
+        {
+            pLevels[i].accepted += shard.accepted[i].load(std::memory_order_relaxed);
+            pLevels[i].dropped += shard.dropped[i].load(std::memory_order_relaxed);
+            pLevels[i].bytes += shard.bytes[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    class ThreadStatisticsShard : public NonCopyable
+    {
+    public:
+        ThreadStatisticsShard()
+        {
+            std::lock_guard<std::mutex> guard(gStatisticsMutex);
+            gStatisticsShards.push_back(&_shard);
+        }
+
+        ~ThreadStatisticsShard()
+        {
+            std::lock_guard<std::mutex> guard(gStatisticsMutex);
+            AddStatistics(_shard, gRetiredStatistics);
+            std::erase(gStatisticsShards, &_shard);
+        }
+
+        StatisticsShard& Get()
+        {
+            return _shard;
+        }
+
+    private:
+        StatisticsShard _shard {};
+    };
+
+    // Sink timing, updated once per batch.
+    static std::atomic<uint64_t> gSinkCallCount = 0;
+    static std::atomic<uint64_t> gSinkTimeNs = 0;
+    static std::atomic<uint64_t> gMaxSinkTimeNs = 0;
+
+    static StatisticsShard& CurrentStatisticsShard()
+    {
+        static thread_local ThreadStatisticsShard tShard;
+        return tShard.Get();
+    }
+
+    // Only the owning thread writes a shard, readers may load it at any time.
+    static void AddToShard(std::atomic<uint64_t>& counter, uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    static void UpdateMax(std::atomic<T>& target, T value)
+    {
+        T current = target.load(std::memory_order_relaxed);
+        while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    static void CountAccepted(Logger::Level level)
+    {
+        AddToShard(CurrentStatisticsShard().accepted[static_cast<int>(level)], 1);
+    }
+
+    static void CountBytes(Logger::Level level, size_t size)
+    {
+        AddToShard(CurrentStatisticsShard().bytes[static_cast<int>(level)], size);
+    }
+
+    static void CountDropped(Logger::Level level)
+    {
+        AddToShard(CurrentStatisticsShard().dropped[static_cast<int>(level)], 1);
+    }
+
+    // Time sink calls, they are made once per batch so two clock reads do not matter.
+    template <typename Call>
+    static void TimeSinkCall(Call&& call)
+    {
+        const auto begin = std::chrono::steady_clock::now();
+        call();
+        const auto elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count());
+
+        gSinkCallCount.fetch_add(1, std::memory_order_relaxed);
+        gSinkTimeNs.fetch_add(elapsed, std::memory_order_relaxed);
+        UpdateMax(gMaxSinkTimeNs, elapsed);
+    }
+
+    /* Each thread keeps its own reference to the current sink table, so the fast path is a
+     * store to its own marker and a load of gSinkTableVersion, no shared reference count is touched. The cached
+     * table is only refreshed at the outermost reader, a sink logging from inside its
+     * callback must not free the table its caller is iterating.
+     *
+     * Caches are registered so RemoveSink can wait for readers of an older table and then
+     * drop the stale references of idle threads, a removed sink is neither called nor kept
+     * alive by the logger once RemoveSink returns.
+     */
+    struct SinkTableCache
+    {
+        // version is written under gSinkTableMutex, depth only by the owning thread.
+        std::atomic<uint64_t> version = 0;
+        std::atomic<int> depth = 0;
+        std::shared_ptr<const SinkTable> pTable;
+    };
+
+    static std::vector<SinkTableCache*> gSinkTableCaches;
+
+    class ThreadSinkTableCache : public NonCopyable
+    {
+    public:
+        ThreadSinkTableCache()
+        {
+            std::lock_guard<std::mutex> guard(gSinkTableMutex);
+            gSinkTableCaches.push_back(&_cache);
+        }
+
+        ~ThreadSinkTableCache()
+        {
+            std::lock_guard<std::mutex> guard(gSinkTableMutex);
+            std::erase(gSinkTableCaches, &_cache);
+        }
+
+        SinkTableCache& Get()
+        {
+            return _cache;
+        }
+
+    private:
+        SinkTableCache _cache;
+    };
+
+    /* Set once RemoveSink registered the process barrier. Readers then mark themselves with a
+     * plain store and a compiler fence, and the remover orders those stores with one barrier on
+     * every thread. Without it readers pay a full fence per call.
+     */
+    static std::atomic<bool> gProcessBarrierReady = false;
+
+    class SinkTableReader : public NonCopyable
+    {
+    public:
+        SinkTableReader()
+            : _cache(GetCache())
+        {
+            // Marked as reading before the version is loaded, pairs with the scan in ReleaseStaleSinkTables.
+            const int depth = _cache.depth.load(std::memory_order_relaxed);
+            if (gProcessBarrierReady.load(std::memory_order_relaxed))
+            {
+                _cache.depth.store(depth + 1, std::memory_order_relaxed);
+                std::atomic_signal_fence(std::memory_order_seq_cst);
+            }
+            else
+                _cache.depth.store(depth + 1, std::memory_order_seq_cst);
+
+            const uint64_t version = gSinkTableVersion.load(std::memory_order_seq_cst);
+            if (version != _cache.version.load(std::memory_order_relaxed) && depth == 0)
+            {
+                std::lock_guard<std::mutex> guard(gSinkTableMutex);
+                _cache.pTable = gSinkTable;
+                _cache.version.store(gSinkTableVersion.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+        }
+
+        ~SinkTableReader()
+        {
+            _cache.depth.store(_cache.depth.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+        }
+
+        const SinkTable& operator*() const
+        {
+            return *_cache.pTable;
+        }
+
+        const SinkTable* operator->() const
+        {
+            return _cache.pTable.get();
+        }
+
+        static SinkTableCache& GetCache()
+        {
+            static thread_local ThreadSinkTableCache tCache;
+            return tCache.Get();
+        }
+
+    private:
+        SinkTableCache& _cache;
+    };
+
+    /* Wait until no other thread reads a table older than version, then drop the stale tables
+     * cached by idle threads. An idle thread reloads the table under gSinkTableMutex the next
+     * time it reads, since its cached version no longer matches. The calling thread is not waited
+     * for, a sink removing itself from its callback keeps the table its caller iterates.
+     */
+    static void ReleaseStaleSinkTables(uint64_t version)
+    {
+        const SinkTableCache* pOwnCache = &SinkTableReader::GetCache();
+
+        // A reader either has its marker visible to the scan below or sees the new version.
+        if (gProcessBarrierReady.load(std::memory_order_relaxed))
+            LogPlatform::ProcessBarrier();
+
+        // Released after the lock, the last reference to a sink may run its destructor.
+        std::vector<std::shared_ptr<const SinkTable>> released;
+        for (;;)
+        {
+            bool reading = false;
+            {
+                std::lock_guard<std::mutex> guard(gSinkTableMutex);
+                for (SinkTableCache* pCache: gSinkTableCaches)
+                {
+                    if (pCache->version.load(std::memory_order_relaxed) >= version)
+                        continue;
+
+                    if (pCache->depth.load(std::memory_order_seq_cst) != 0)
+                    {
+                        reading = reading || pCache != pOwnCache;
+                        continue;
+                    }
+
+                    if (pCache->pTable != nullptr)
+                        released.push_back(std::move(pCache->pTable));
+
+                    pCache->version.store(0, std::memory_order_relaxed);
+                }
+            }
+
+            if (!reading)
+                return;
+
+            std::this_thread::yield();
+        }
+    }
+
+    // Returns the version of the new table.
+    template <typename Modify>
+    static uint64_t ModifySinkTable(Modify&& modify)
+    {
+        std::lock_guard<std::mutex> guard(gSinkTableMutex);
+
+        auto pNewTable = std::make_shared<SinkTable>(*gSinkTable);
+        modify(*pNewTable);
+
+        gSinkTable = std::move(pNewTable);
+        return gSinkTableVersion.fetch_add(1, std::memory_order_seq_cst) + 1;
+    }
+
+    struct LoggerImpl
+    {
+        // Message of the record must be null terminated, it is passed to LogCallBack as is.
+        static void Dispatch(const SinkTable& table, const LogRecord& record)
+        {
+            const int levelIndex = static_cast<int>(record.level);
+
+            for (const auto p: table.recordCallVec[levelIndex])
+                p(record);
+
+            for (const auto p: table.callVec[levelIndex])
+                p(record.message.data());
+        }
+
+        static void DispatchBatch(const SinkTable& table, std::span<const LogRecord> records)
+        {
+            if (records.empty() || table.sinkVec.empty())
+                return;
+
+            TimeSinkCall([&]() -> void
+            {
+                for (const auto& pSink: table.sinkVec)
+                    pSink->OnBatch(records);
+            });
+        }
+
+        static LogRecord MakeRecord(const LogCategory& category, Logger::Level level, const std::source_location& location)
+        {
+            static thread_local const uint64_t tThreadId = LogPlatform::CurrentThreadId();
+
+            const int64_t timestamp = LogPlatform::CoarseTimestamp();
+            UpdateCachedTimestamp(timestamp);
+            return LogRecord{ level, &category, timestamp, tThreadId, location, {} };
+        }
+
+        // The coarse clock ticks every few milliseconds, so the shared line is written about as rarely.
+        static void UpdateCachedTimestamp(int64_t timestamp)
+        {
+            if (Logger::_cachedTimestamp.load(std::memory_order_relaxed) != timestamp)
+                Logger::_cachedTimestamp.store(timestamp, std::memory_order_relaxed);
+        }
+
+        static void Log(const LogCategory& category, Logger::Level level, const std::source_location& location, const char* message);
+    };
+
+    /* Per-thread staging for sync mode, records are copied into the thread's own buffer
+     * and handed to sinks as one batch when the buffer is full, an error is logged, the
+     * oldest staged record is older than maxStagingDelayMs, Logger::Flush is called or
+     * the thread exits. The delay is also checked by a flusher thread, so records of a
+     * thread that stopped logging do not wait for its next log call.
+     *
+     * Staged text is swapped out under the mutex and sinks are called without it. Sinks
+     * calling back into Logger from OnBatch are fine, a thread passing a staged batch to
+     * sinks never flushes itself, records it logs meanwhile go out with the next flush.
+     */
+    class StagingBuffer : public NonCopyable
+    {
+    public:
+        StagingBuffer();
+
+    public:
+        void Append(const LogRecord& record);
+        void Flush();
+
+        // Flush only if the oldest staged record was logged before deadline.
+        void FlushIfOlder(int64_t deadline);
+
+    private:
+        struct StagedRecord
+        {
+            LogRecord record;
+            size_t offset;
+        };
+
+        struct Staging
+        {
+            std::vector<char> text;
+            std::vector<StagedRecord> staged;
+        };
+
+        // Guards _filling, held only to append or swap.
+        std::mutex _mutex;
+        Staging _filling;
+        int64_t _oldestTimestamp = INT64_MAX;
+
+        // Guards _dispatching and keeps batches of this buffer in order.
+        std::mutex _dispatchMutex;
+        Staging _dispatching;
+        std::vector<LogRecord> _records;
+    };
+
+    static thread_local bool tStagingDispatching = false;
+
+    StagingBuffer::StagingBuffer()
+    {
+        _filling.text.reserve(gStagingBufferSize.load(std::memory_order_relaxed));
+        _filling.staged.reserve(gStagingRecordCount.load(std::memory_order_relaxed));
+    }
+
+    void StagingBuffer::Append(const LogRecord& record)
+    {
+        const size_t size = record.message.size();
+        const size_t bufferSize = gStagingBufferSize.load(std::memory_order_relaxed);
+
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        if (!_filling.staged.empty() && _filling.text.size() + size > bufferSize && !tStagingDispatching)
+        {
+            lock.unlock();
+            Flush();
+            lock.lock();
+        }
+
+        if (_filling.staged.empty())
+            _oldestTimestamp = record.timestamp;
+
+        _filling.staged.push_back(StagedRecord{ record, _filling.text.size() });
+        _filling.text.insert(_filling.text.end(), record.message.begin(), record.message.end());
+
+        const int64_t maxDelay = static_cast<int64_t>(gMaxStagingDelayMs.load(std::memory_order_relaxed)) * 1000000;
+        const bool flush = record.level >= Logger::Level::Error
+            || _filling.staged.size() >= gStagingRecordCount.load(std::memory_order_relaxed)
+            || _filling.text.size() >= bufferSize
+            || record.timestamp - _oldestTimestamp >= maxDelay;
+
+        lock.unlock();
+
+        if (flush)
+            Flush();
+    }
+
+    void StagingBuffer::FlushIfOlder(int64_t deadline)
+    {
+        {
+            std::lock_guard<std::mutex> guard(_mutex);
+            if (_filling.staged.empty() || _oldestTimestamp > deadline)
+                return;
+        }
+
+        Flush();
+    }
+
+    void StagingBuffer::Flush()
+    {
+        if (tStagingDispatching)
+            return;
+
+        std::lock_guard<std::mutex> dispatchGuard(_dispatchMutex);
+        {
+            std::lock_guard<std::mutex> guard(_mutex);
+            if (_filling.staged.empty())
+                return;
+
+            // Both sides keep their capacity, the next records reuse the buffers of the last batch.
+            std::swap(_filling, _dispatching);
+            _oldestTimestamp = INT64_MAX;
+        }
+
+        _records.clear();
+        for (const auto& staged: _dispatching.staged)
+        {
+            LogRecord record = staged.record;
+            record.message = std::string_view(_dispatching.text.data() + staged.offset, staged.record.message.size());
+            _records.push_back(record);
+        }
+
+        tStagingDispatching = true;
+        ScopeGuard dispatchingGuard = [] { tStagingDispatching = false; };
+
+        const SinkTableReader table;
+        LoggerImpl::DispatchBatch(*table, _records);
+
+        _dispatching.staged.clear();
+        _dispatching.text.clear();
+    }
+
+    /* Buffers are shared with the registry, so the flusher and Logger::Flush can call sinks
+     * without holding the registry lock while the owning thread exits. A thread's buffer is
+     * created on its first staged record, which also starts the flusher.
+     */
+    static std::mutex gStagingRegistryMutex = {};
+    static std::vector<std::shared_ptr<StagingBuffer>> gStagingRegistry;
+
+    /* Background thread flushing staging buffers of idle threads, reporting suppressed
+     * messages of rate limited sites and ticking sinks. Started by the first staging buffer,
+     * suppression or sink.
+     */
+    static std::mutex gFlusherMutex = {};
+    static std::condition_variable gFlusherCondition;
+    static bool gFlusherStopped = false;
+    static std::thread gFlusher;
+
+    // Set while a rate limited site holds suppressed messages, the flusher then wakes more often.
+    static std::atomic<bool> gSuppressionPending = false;
+    static constexpr auto SUPPRESSION_REPORT_PERIOD = std::chrono::milliseconds(10);
+
+    // Upper bound of the wait between LogSink::OnTick calls.
+    static constexpr auto SINK_TICK_PERIOD = std::chrono::milliseconds(50);
+
+    static std::vector<std::shared_ptr<StagingBuffer>> SnapshotStagingBuffers()
+    {
+        std::lock_guard<std::mutex> guard(gStagingRegistryMutex);
+        return gStagingRegistry;
+    }
+
+    static void FlushAllStagingBuffers()
+    {
+        for (const auto& pBuffer: SnapshotStagingBuffers())
+            pBuffer->Flush();
+    }
+
+    static void FlusherLoop()
+    {
+        std::unique_lock<std::mutex> lock(gFlusherMutex);
+        while (!gFlusherStopped)
+        {
+            // Half the delay between checks, a record waits at most 1.5 times maxStagingDelayMs.
+            auto period = std::chrono::milliseconds(std::max<uint32_t>(gMaxStagingDelayMs.load(std::memory_order_relaxed) / 2, 1));
+            period = std::min<std::chrono::milliseconds>(period, SINK_TICK_PERIOD);
+            if (gSuppressionPending.load(std::memory_order_relaxed))
+                period = std::min<std::chrono::milliseconds>(period, SUPPRESSION_REPORT_PERIOD);
+
+            gFlusherCondition.wait_for(lock, period);
+            if (gFlusherStopped)
+                break;
+
+            lock.unlock();
+
+            const int64_t now = Logger::GetCoarseTimestamp();
+            LoggerImpl::UpdateCachedTimestamp(now);
+
+            // Cleared before the scan, a site starting to suppress meanwhile sets it again.
+            gSuppressionPending.store(false, std::memory_order_relaxed);
+            if (LogRateLimiter::ReportPending(false))
+                gSuppressionPending.store(true, std::memory_order_relaxed);
+
+            const int64_t deadline = now - static_cast<int64_t>(gMaxStagingDelayMs.load(std::memory_order_relaxed)) * 1000000;
+            for (const auto& pBuffer: SnapshotStagingBuffers())
+                pBuffer->FlushIfOlder(deadline);
+
+            {
+                const SinkTableReader table;
+                for (const auto& pSink: table->sinkVec)
+                    pSink->OnTick(now);
+            }
+
+            lock.lock();
+        }
+    }
+
+    static void StartFlusher()
+    {
+        std::lock_guard<std::mutex> guard(gFlusherMutex);
+        if (!gFlusher.joinable() && !gFlusherStopped)
+            gFlusher = std::thread(FlusherLoop);
+    }
+
+    // Wake the flusher so it picks up a changed delay or a new suppression.
+    static void WakeFlusher()
+    {
+        std::lock_guard<std::mutex> guard(gFlusherMutex);
+        gFlusherCondition.notify_one();
+    }
+
+    // Stop the flusher on exit, before the registry it walks is destroyed.
+    struct FlusherExitGuard
+    {
+        ~FlusherExitGuard()
+        {
+            {
+                std::lock_guard<std::mutex> guard(gFlusherMutex);
+                gFlusherStopped = true;
+                gFlusherCondition.notify_one();
+            }
+
+            if (gFlusher.joinable())
+                gFlusher.join();
+        }
+    };
+
+    static FlusherExitGuard gFlusherExitGuard;
+
+    // Owned by the logging thread, unregisters and delivers what is left when the thread exits.
+    class ThreadStagingBuffer : public NonCopyable
+    {
+    public:
+        ThreadStagingBuffer()
+            : _pBuffer(std::make_shared<StagingBuffer>())
+        {
+            {
+                std::lock_guard<std::mutex> guard(gStagingRegistryMutex);
+                gStagingRegistry.push_back(_pBuffer);
+            }
+
+            StartFlusher();
+        }
+
+        ~ThreadStagingBuffer()
+        {
+            {
+                std::lock_guard<std::mutex> guard(gStagingRegistryMutex);
+                std::erase(gStagingRegistry, _pBuffer);
+            }
+
+            _pBuffer->Flush();
+        }
+
+        StagingBuffer* operator->() const
+        {
+            return _pBuffer.get();
+        }
+
+    private:
+        std::shared_ptr<StagingBuffer> _pBuffer;
+    };
+
+    /* In-flight marker of one producer thread, raised before it loads gAsyncQueue and lowered
+     * after its push. Once StopAsync has cleared gAsyncQueue and seen every marker down, no
+     * push into the old queue can follow its final drain. Only the owning thread writes it.
+     */
+    struct alignas(64) AsyncProducerMarker
+    {
+        std::atomic<uint32_t> depth = 0;
+    };
+
+    static std::mutex gAsyncProducerMutex = {};
+    static std::vector<const AsyncProducerMarker*> gAsyncProducers;
+
+    class ThreadAsyncProducer : public NonCopyable
+    {
+    public:
+        ThreadAsyncProducer()
+        {
+            std::lock_guard<std::mutex> guard(gAsyncProducerMutex);
+            gAsyncProducers.push_back(&_marker);
+        }
+
+        ~ThreadAsyncProducer()
+        {
+            std::lock_guard<std::mutex> guard(gAsyncProducerMutex);
+            std::erase(gAsyncProducers, &_marker);
+        }
+
+        AsyncProducerMarker& Get()
+        {
+            return _marker;
+        }
+
+    private:
+        AsyncProducerMarker _marker;
+    };
+
+    // Queue to push into during the scope, null in sync mode, where it costs the same single load as before.
+    class AsyncProducerScope : public NonCopyable
+    {
+    public:
+        AsyncProducerScope()
+        {
+            if (gAsyncQueue.load(std::memory_order_relaxed) == nullptr)
+                return;
+
+            static thread_local ThreadAsyncProducer tProducer;
+            _pMarker = &tProducer.Get();
+
+            // Store and load are both seq_cst, pairs with the exchange and marker loads in StopAsync.
+            _pMarker->depth.store(_pMarker->depth.load(std::memory_order_relaxed) + 1, std::memory_order_seq_cst);
+            _pQueue = gAsyncQueue.load(std::memory_order_seq_cst);
+        }
+
+        ~AsyncProducerScope()
+        {
+            if (_pMarker != nullptr)
+                _pMarker->depth.store(_pMarker->depth.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+        }
+
+        AsyncLogQueue* Get() const
+        {
+            return _pQueue;
+        }
+
+    private:
+        AsyncProducerMarker* _pMarker = nullptr;
+        AsyncLogQueue* _pQueue = nullptr;
+    };
+
+    static bool IsAnyAsyncProducerInFlight()
+    {
+        std::lock_guard<std::mutex> guard(gAsyncProducerMutex);
+        return std::any_of(gAsyncProducers.begin(), gAsyncProducers.end(), [](const AsyncProducerMarker* pMarker) -> bool
+        {
+            return pMarker->depth.load(std::memory_order_seq_cst) != 0;
+        });
+    }
+
+    static void WakeAsyncWorker()
+    {
+        std::lock_guard<std::mutex> guard(gAsyncWakeMutex);
+        gAsyncWakeCondition.notify_one();
+    }
+
+    static void WakeAsyncWorkerIfSleeping()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (gAsyncWorkerSleeping.load(std::memory_order_relaxed))
+            WakeAsyncWorker();
+    }
+
+    static void ReleaseAsyncEntry(AsyncLogEntry& entry)
+    {
+        if (entry.pDestroyFunc != nullptr)
+            entry.pDestroyFunc(entry.args);
+
+        entry.pFormatFunc = nullptr;
+        entry.pDestroyFunc = nullptr;
+        entry.message.clear();
+    }
+
+    static void TakeAsyncEntry(AsyncLogEntry& entry, AsyncDrainedEntry& output)
+    {
+        output.record = entry.record;
+
+        if (entry.pFormatFunc == nullptr)
+        {
+            output.message = std::move(entry.message);
+            return;
+        }
+
+        // Slot must be released even if formatting throws, producers wait on it when full.
+        try
+        {
+            entry.pFormatFunc(entry.format, entry.args, output.message);
+        }
+        catch (...)
+        {
+            output.message.assign("[Logger] format error");
+        }
+
+        CountBytes(output.record.level, output.message.size());
+        ReleaseAsyncEntry(entry);
+    }
+
+    static void ReleaseDroppedAsyncEntry(AsyncLogEntry& entry)
+    {
+        CountDropped(entry.record.level);
+        ReleaseAsyncEntry(entry);
+    }
+
+    template <typename Fill>
+    static bool EnqueueAsync(AsyncLogQueue* pQueue, Logger::Level level, Fill&& fill)
+    {
+        if (pQueue->TryPush(fill))
+        {
+            WakeAsyncWorkerIfSleeping();
+            return true;
+        }
+
+        UpdateMax(gAsyncQueueHighWaterMark, pQueue->Capacity());
+
+        switch (gAsyncOverflowPolicy.load(std::memory_order_relaxed))
+        {
+            case Logger::OverflowPolicy::DropNewest:
+            {
+                gAsyncDroppedNewestCount.fetch_add(1, std::memory_order_relaxed);
+                CountDropped(level);
+                return false;
+            }
+            case Logger::OverflowPolicy::DropOldest:
+            {
+                while (!pQueue->TryPush(fill))
+                {
+                    if (pQueue->TryPop(ReleaseDroppedAsyncEntry))
+                        gAsyncDroppedOldestCount.fetch_add(1, std::memory_order_relaxed);
+                }
+                break;
+            }
+            case Logger::OverflowPolicy::Block:
+            default:
+            {
+                // A sink logging on the worker would wait for itself, its record is dropped instead.
+                if (tAsyncWorker)
+                {
+                    gAsyncDroppedNewestCount.fetch_add(1, std::memory_order_relaxed);
+                    CountDropped(level);
+                    return false;
+                }
+
+                gAsyncBlockedCount.fetch_add(1, std::memory_order_relaxed);
+                while (!pQueue->TryPush(fill))
+                {
+                    WakeAsyncWorker();
+                    std::this_thread::yield();
+                }
+                break;
+            }
+        }
+
+        WakeAsyncWorkerIfSleeping();
+        return true;
+    }
+
+    static size_t DrainAsyncQueue(AsyncLogQueue* pQueue, std::vector<AsyncDrainedEntry>& batch, std::vector<LogRecord>& records)
+    {
+        size_t total = 0;
+        while (true)
+        {
+            // Depth before the batch, the worker sees the queue at its fullest.
+            UpdateMax(gAsyncQueueHighWaterMark, pQueue->EnqueuePosition() - pQueue->DequeuePosition());
+
+            // Entries are reused between drains to keep their string capacity.
+            size_t count = 0;
+            while (count < ASYNC_DRAIN_BATCH_SIZE)
+            {
+                if (count == batch.size())
+                    batch.emplace_back();
+
+                if (!pQueue->TryPop([&](AsyncLogEntry& entry) -> void { TakeAsyncEntry(entry, batch[count]); }))
+                    break;
+
+                count++;
+            }
+
+            if (count == 0)
+                break;
+
+            records.clear();
+            for (size_t i = 0; i < count; i++)
+            {
+                batch[i].record.message = batch[i].message;
+                records.push_back(batch[i].record);
+            }
+
+            if (LogFlightRecorder* pRecorder = gFlightRecorder.load(std::memory_order_acquire); pRecorder != nullptr)
+            {
+                for (const auto& record: records)
+                    pRecorder->Write(record);
+            }
+
+            {
+                const SinkTableReader table;
+                for (const auto& record: records)
+                    LoggerImpl::Dispatch(*table, record);
+
+                LoggerImpl::DispatchBatch(*table, records);
+            }
+
+            total += count;
+            gAsyncDeliveredPos.store(pQueue->DequeuePosition(), std::memory_order_release);
+        }
+
+        return total;
+    }
+
+    static void AsyncWorkerLoop(AsyncLogQueue* pQueue)
+    {
+        // Sinks run on this thread, a crash inside one should still reach the flight recorder.
+        LogFlightRecorder::InstallSignalStack();
+        tAsyncWorker = true;
+
+        std::vector<AsyncDrainedEntry> batch;
+        std::vector<LogRecord> records;
+        batch.reserve(ASYNC_DRAIN_BATCH_SIZE);
+        records.reserve(ASYNC_DRAIN_BATCH_SIZE);
+
+        while (true)
+        {
+            const bool running = gAsyncRunning.load(std::memory_order_acquire);
+            if (DrainAsyncQueue(pQueue, batch, records) > 0)
+                continue;
+
+            if (!running)
+                break;
+
+            // Publish sleeping before the last emptiness check, pairs with the fence in producers.
+            gAsyncWorkerSleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (pQueue->Empty() && gAsyncRunning.load(std::memory_order_acquire))
+            {
+                std::unique_lock<std::mutex> lock(gAsyncWakeMutex);
+                gAsyncWakeCondition.wait_for(lock, ASYNC_WORKER_IDLE_WAIT);
+            }
+            gAsyncWorkerSleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    void LoggerImpl::Log(const LogCategory& category, Logger::Level level, const std::source_location& location, const char* message)
+    {
+        LogRecord record = MakeRecord(category, level, location);
+        record.message = message;
+
+        CountAccepted(level);
+        CountBytes(level, record.message.size());
+
+        if (const AsyncProducerScope producer; producer.Get() != nullptr)
+        {
+            EnqueueAsync(producer.Get(), level, [&](AsyncLogEntry& entry) -> void
+            {
+                entry.record = record;
+
+                // The cell is published even if the copy throws, it must not carry a stale message.
+                try
+                {
+                    entry.message.assign(record.message);
+                }
+                catch (...)
+                {
+                    entry.message.clear();
+                    throw;
+                }
+            });
+            return;
+        }
+
+        if (LogFlightRecorder* pRecorder = gFlightRecorder.load(std::memory_order_acquire); pRecorder != nullptr)
+            pRecorder->Write(record);
+
+        const SinkTableReader table;
+        Dispatch(*table, record);
+
+        if (!table->sinkVec.empty())
+        {
+            static thread_local ThreadStagingBuffer tStagingBuffer;
+            tStagingBuffer->Append(record);
+        }
+    }
+
+    /* Crash path, sync records and drained async records are already in the recorder, only
+     * records still waiting in the async queue are copied. Runs in a signal handler, so deferred
+     * records are not formatted since formatting allocates, their format string is written
+     * instead, and timestamps are written as raw nanoseconds since epoch.
+     */
+    static void WritePendingToFlightRecorder()
+    {
+        LogFlightRecorder* pRecorder = gFlightRecorder.load(std::memory_order_acquire);
+        AsyncLogQueue* pQueue = gAsyncQueue.load(std::memory_order_acquire);
+        if (pRecorder == nullptr || pQueue == nullptr)
+            return;
+
+        pQueue->PeekPending([&](const AsyncLogEntry& entry) -> void
+        {
+            LogRecord record = entry.record;
+            record.message = entry.pFormatFunc == nullptr ? std::string_view(entry.message) : entry.format;
+            pRecorder->WriteInSignalHandler(record);
+        });
+    }
+
+    // Stop worker thread on exit, a joinable std::thread in static destruction terminates.
+    struct AsyncWorkerExitGuard
+    {
+        ~AsyncWorkerExitGuard()
+        {
+            Logger::StopAsync();
+        }
+    };
+
+    static AsyncWorkerExitGuard gAsyncWorkerExitGuard;
 
-namespace Infra
-{
     void Logger::SetFilterLevel(Level targetLevel)
     {
-        _filterLevel = targetLevel;
+        std::lock_guard<std::mutex> guard(gCategoryLevelMutex);
+
+        gFilterLevel.store(targetLevel, std::memory_order_relaxed);
+        for (size_t i = 0; i < MAX_CATEGORY_COUNT; i++)
+        {
+            if (!gCategoryLevelOverridden[i])
+                _categoryLevel[i].level.store(targetLevel, std::memory_order_relaxed);
+        }
     }
 
     Logger::Level Logger::GetCurrentFilterLevel()
     {
-        return _filterLevel;
+        return gFilterLevel.load(std::memory_order_relaxed);
+    }
+
+    void Logger::SetCategoryLevel(const LogCategory& category, Level targetLevel)
+    {
+        std::lock_guard<std::mutex> guard(gCategoryLevelMutex);
+
+        gCategoryLevelOverridden[category.id] = true;
+        _categoryLevel[category.id].level.store(targetLevel, std::memory_order_relaxed);
+    }
+
+    void Logger::ResetCategoryLevel(const LogCategory& category)
+    {
+        std::lock_guard<std::mutex> guard(gCategoryLevelMutex);
+
+        gCategoryLevelOverridden[category.id] = false;
+        _categoryLevel[category.id].level.store(gFilterLevel.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    Logger::Level Logger::GetCategoryLevel(const LogCategory& category)
+    {
+        return _categoryLevel[category.id].level.load(std::memory_order_relaxed);
+    }
+
+    bool Logger::RegisterCategory(const LogCategory& category)
+    {
+        std::lock_guard<std::mutex> guard(gCategoryLevelMutex);
+
+        // Compared by address, a header category included by several translation units is one object.
+        const LogCategory*& pOwner = gRegisteredCategories[category.id];
+        if (pOwner != nullptr && pOwner != &category)
+            return false;
+
+        pOwner = &category;
+        return true;
+    }
+
+    const char* Logger::GetLevelName(Level level)
+    {
+        switch (level)
+        {
+            case Level::Trace:
+                return "TRACE";
+            case Level::Debug:
+                return "DEBUG";
+            case Level::Info:
+                return "INFO";
+            case Level::Warning:
+                return "WARN";
+            case Level::Error:
+                return "ERROR";
+        }
+
+        return "UNKNOWN";
+    }
+
+    int64_t Logger::GetCoarseTimestamp()
+    {
+        return LogPlatform::CoarseTimestamp();
+    }
+
+    int64_t Logger::RefreshCachedTimestamp()
+    {
+        const int64_t timestamp = LogPlatform::CoarseTimestamp();
+        LoggerImpl::UpdateCachedTimestamp(timestamp);
+        return timestamp;
     }
 
-    void Logger::LogInfo(const std::string& message)
+    void Logger::WakeSuppressionReport()
     {
-        if (static_cast<int>(_filterLevel) > static_cast<int>(Logger::Level::Info))
+        if (gSuppressionPending.load(std::memory_order_relaxed) || gSuppressionPending.exchange(true, std::memory_order_relaxed))
             return;
 
-        LogInfo(message.c_str());
+        StartFlusher();
+        WakeFlusher();
+    }
+
+    size_t Logger::FormatTimestamp(int64_t timestamp, char* pBuffer, size_t bufferSize)
+    {
+        struct TimestampCache
+        {
+            int64_t second = INT64_MIN;
+            char prefix[20] {}; // "YYYY-MM-DD HH:MM:SS "
+        };
+
+        static thread_local TimestampCache tCache;
+
+        if (pBuffer == nullptr || bufferSize < TIMESTAMP_SIZE)
+            return 0;
+
+        int64_t second = timestamp / 1000000000;
+        int64_t nanosecond = timestamp % 1000000000;
+        if (nanosecond < 0)
+        {
+            second -= 1;
+            nanosecond += 1000000000;
+        }
+
+        if (second != tCache.second)
+        {
+            tm localTime {};
+            if (!LogPlatform::LocalTime(static_cast<time_t>(second), localTime))
+                return 0;
+
+            std::strftime(tCache.prefix, sizeof(tCache.prefix), "%Y-%m-%d %H:%M:%S", &localTime);
+            tCache.prefix[19] = '.';
+            tCache.second = second;
+        }
+
+        std::memcpy(pBuffer, tCache.prefix, sizeof(tCache.prefix));
+
+        int64_t microsecond = nanosecond / 1000;
+        for (size_t i = TIMESTAMP_SIZE; i > sizeof(tCache.prefix); i--)
+        {
+            pBuffer[i - 1] = static_cast<char>('0' + microsecond % 10);
+            microsecond /= 10;
+        }
+
+        if (bufferSize > TIMESTAMP_SIZE)
+            pBuffer[TIMESTAMP_SIZE] = '\0';
+
+        return TIMESTAMP_SIZE;
+    }
+
+    bool Logger::StartAsync()
+    {
+        return StartAsync(AsyncConfig{});
+    }
+
+    bool Logger::StartAsync(const AsyncConfig& config)
+    {
+        std::lock_guard<std::mutex> guard(gAsyncControlMutex);
+
+        if (gAsyncRunning.load(std::memory_order_acquire))
+            return false;
+
+        // Old queue is retired instead of freed, a producer may still hold the pointer it loaded.
+        if (gAsyncQueueStorage == nullptr || gAsyncQueueStorage->Capacity() < config.queueCapacity)
+        {
+            if (gAsyncQueueStorage != nullptr)
+                gAsyncRetiredQueues.push_back(std::move(gAsyncQueueStorage));
+
+            gAsyncQueueStorage = std::make_unique<AsyncLogQueue>(config.queueCapacity);
+        }
+
+        AsyncLogQueue* pQueue = gAsyncQueueStorage.get();
+
+        gAsyncOverflowPolicy.store(config.overflowPolicy, std::memory_order_relaxed);
+        gAsyncDeliveredPos.store(pQueue->DequeuePosition(), std::memory_order_relaxed);
+        gAsyncRunning.store(true, std::memory_order_release);
+        gAsyncWorker = std::thread(AsyncWorkerLoop, pQueue);
+        gAsyncQueue.store(pQueue, std::memory_order_release);
+
+        return true;
     }
 
-    void Logger::LogInfo(const char* message)
+    void Logger::StopAsync()
     {
-        if (static_cast<int>(_filterLevel) > static_cast<int>(Logger::Level::Info))
+        std::lock_guard<std::mutex> guard(gAsyncControlMutex);
+
+        if (!gAsyncRunning.load(std::memory_order_acquire))
             return;
 
-        std::lock_guard<std::mutex> guard(gMutex);
+        AsyncLogQueue* pQueue = gAsyncQueue.exchange(nullptr, std::memory_order_seq_cst);
+
+        gAsyncRunning.store(false, std::memory_order_release);
+        WakeAsyncWorker();
+
+        if (gAsyncWorker.joinable())
+            gAsyncWorker.join();
+
+        // Producers which loaded the queue before the exchange may still push, a blocked one needs
+        // room to finish. Markers are checked before draining, so the last drain sees every push.
+        std::vector<AsyncDrainedEntry> batch;
+        std::vector<LogRecord> records;
+        while (true)
+        {
+            const bool inFlight = IsAnyAsyncProducerInFlight();
+            DrainAsyncQueue(pQueue, batch, records);
+            if (!inFlight)
+                break;
+
+            std::this_thread::yield();
+        }
+    }
+
+    bool Logger::IsAsync()
+    {
+        return gAsyncQueue.load(std::memory_order_acquire) != nullptr;
+    }
+
+    void Logger::Flush()
+    {
+        // Summaries of rate limited sites first, so they are delivered by this flush too.
+        LogRateLimiter::ReportPending(true);
+
+        // A sink flushing on the worker would wait for itself, what it queued follows its batch.
+        if (AsyncLogQueue* pQueue = gAsyncQueue.load(std::memory_order_acquire); pQueue != nullptr && !tAsyncWorker)
         {
-            for (const auto p: _logInfoCallVec)
+            const size_t target = pQueue->EnqueuePosition();
+            while (gAsyncDeliveredPos.load(std::memory_order_acquire) < target && gAsyncRunning.load(std::memory_order_acquire))
             {
-                if (p != nullptr)
-                    p(message);
+                WakeAsyncWorker();
+                std::this_thread::yield();
             }
         }
+
+        FlushAllStagingBuffers();
+
+        const SinkTableReader table;
+        if (table->sinkVec.empty())
+            return;
+
+        TimeSinkCall([&]() -> void
+        {
+            for (const auto& pSink: table->sinkVec)
+                pSink->OnFlush();
+        });
+    }
+
+    bool Logger::EnableFlightRecorder(const std::string& path, size_t fileSize)
+    {
+        std::lock_guard<std::mutex> guard(gFlightRecorderMutex);
+
+        auto pRecorder = LogFlightRecorder::Create(path, fileSize);
+        if (pRecorder == nullptr)
+            return false;
+
+        if (gFlightRecorderStorage != nullptr)
+            gRetiredFlightRecorders.push_back(std::move(gFlightRecorderStorage));
+
+        gFlightRecorderStorage = std::move(pRecorder);
+        gFlightRecorder.store(gFlightRecorderStorage.get(), std::memory_order_release);
+
+        LogFlightRecorder::InstallCrashHandler(WritePendingToFlightRecorder);
+        return true;
+    }
+
+    void Logger::DisableFlightRecorder()
+    {
+        std::lock_guard<std::mutex> guard(gFlightRecorderMutex);
+
+        gFlightRecorder.store(nullptr, std::memory_order_release);
+        if (gFlightRecorderStorage != nullptr)
+            gRetiredFlightRecorders.push_back(std::move(gFlightRecorderStorage));
+    }
+
+    std::string Logger::ReadFlightRecorder(const std::string& path)
+    {
+        return LogFlightRecorder::ReadFile(path);
     }
 
-    void Logger::LogWarn(const std::string& message)
+    void Logger::AddSink(const std::shared_ptr<LogSink>& pSink)
     {
-        if (static_cast<int>(_filterLevel) > static_cast<int>(Logger::Level::Warning))
+        if (pSink == nullptr)
             return;
 
-        LogWarn(message.c_str());
+        ModifySinkTable([&](SinkTable& table) -> void
+        {
+            table.sinkVec.push_back(pSink);
+        });
+
+        StartFlusher();
     }
 
-    void Logger::LogWarn(const char* message)
+    void Logger::RemoveSink(const std::shared_ptr<LogSink>& pSink)
     {
-        if (static_cast<int>(_filterLevel) > static_cast<int>(Logger::Level::Warning))
+        if (pSink == nullptr)
             return;
 
-        std::lock_guard<std::mutex> guard(gMutex);
+        // Registered before the table changes, once a reader takes the cheap path every later
+        // remover issues the barrier.
+        static const bool processBarrierRegistered = LogPlatform::RegisterProcessBarrier();
+        if (processBarrierRegistered)
+            gProcessBarrierReady.store(true, std::memory_order_relaxed);
+
+        // Staged records may belong to this sink, deliver them first.
+        FlushAllStagingBuffers();
+
+        const uint64_t version = ModifySinkTable([&](SinkTable& table) -> void
         {
-            for (const auto p: _logWarnCallVec)
-            {
-                if (p != nullptr)
-                    p(message);
-            }
-        }
+            std::erase(table.sinkVec, pSink);
+        });
+
+        // Batches dispatched from the old table finish before the sink is flushed for the last time.
+        ReleaseStaleSinkTables(version);
+        pSink->OnFlush();
     }
 
-    void Logger::LogError(const std::string& message)
+    void Logger::AddCallBack(Level level, LogCallBack pFunc)
     {
-        if (static_cast<int>(_filterLevel) > static_cast<int>(Logger::Level::Error))
+        if (pFunc == nullptr)
             return;
 
-        LogError(message.c_str());
+        ModifySinkTable([&](SinkTable& table) -> void
+        {
+            table.callVec[static_cast<int>(level)].push_back(pFunc);
+        });
     }
 
-    void Logger::LogError(const char* message)
+    void Logger::AddRecordCallBack(Level level, LogRecordCallBack pFunc)
     {
-        if (static_cast<int>(_filterLevel) > static_cast<int>(Logger::Level::Error))
+        if (pFunc == nullptr)
             return;
 
-        std::lock_guard<std::mutex> guard(gMutex);
+        ModifySinkTable([&](SinkTable& table) -> void
+        {
+            table.recordCallVec[static_cast<int>(level)].push_back(pFunc);
+        });
+    }
+
+    void Logger::SetBatchConfig(const BatchConfig& config)
+    {
+        gStagingRecordCount.store(std::max<size_t>(config.stagingRecordCount, 1), std::memory_order_relaxed);
+        gStagingBufferSize.store(config.stagingBufferSize, std::memory_order_relaxed);
+        gMaxStagingDelayMs.store(config.maxStagingDelayMs, std::memory_order_relaxed);
+        WakeFlusher();
+    }
+
+    bool Logger::TryEnqueueDeferred(const LogCategory& category, Level level, const std::source_location& location, const DeferredFormat& deferred, void* pContext)
+    {
+        const AsyncProducerScope producer;
+        if (producer.Get() == nullptr)
+            return false;
+
+        // Bytes are counted by the worker once the message is formatted.
+        CountAccepted(level);
+
+        const LogRecord record = LoggerImpl::MakeRecord(category, level, location);
+        EnqueueAsync(producer.Get(), level, [&](AsyncLogEntry& entry) -> void
         {
-            for (const auto p: _logErrorCallVec)
+            entry.record = record;
+            entry.format = deferred.format;
+
+            // Slot is already reserved, it must be published even if copying arguments throws.
+            try
+            {
+                deferred.pConstructFunc(entry.args, pContext);
+                entry.pFormatFunc = deferred.pFormatFunc;
+                entry.pDestroyFunc = deferred.pDestroyFunc;
+            }
+            catch (...)
             {
-                if (p != nullptr)
-                    p(message);
+                entry.pFormatFunc = nullptr;
+                entry.pDestroyFunc = nullptr;
+                entry.message.clear();
             }
+        });
+
+        return true;
+    }
+
+    void Logger::LogMessage(const LogCategory& category, Level level, const std::source_location& location, const char* message)
+    {
+        LoggerImpl::Log(category, level, location, message);
+    }
+
+    void Logger::LogFormatToBuffer(const LogCategory& category, Level level, const std::source_location& location, FormatToBufferFunc pFormatFunc, void* pContext)
+    {
+        struct FormatBuffer
+        {
+            bool busy = false;
+            char data[FORMAT_BUFFER_SIZE];
+        };
+
+        static_assert(FORMAT_BUFFER_SIZE > TRUNCATED_MARKER.size() + 1, "INFRA_LOG_FORMAT_BUFFER_SIZE too small");
+
+        static thread_local FormatBuffer tBuffer;
+
+        // A formatter or sink logging while the buffer is in use gets its own heap buffer.
+        std::unique_ptr<char[]> pNestedBuffer;
+        char* pBuffer = tBuffer.data;
+        if (tBuffer.busy)
+        {
+            pNestedBuffer = std::make_unique<char[]>(FORMAT_BUFFER_SIZE);
+            pBuffer = pNestedBuffer.get();
+        }
+
+        const bool ownBuffer = pNestedBuffer == nullptr;
+        if (ownBuffer)
+            tBuffer.busy = true;
+
+        ScopeGuard busyGuard = [ownBuffer] { if (ownBuffer) tBuffer.busy = false; };
+
+        size_t size = pFormatFunc(pBuffer, FORMAT_BUFFER_SIZE - 1, pContext);
+        if (size > FORMAT_BUFFER_SIZE - 1)
+        {
+            size = FORMAT_BUFFER_SIZE - 1;
+            std::memcpy(pBuffer + size - TRUNCATED_MARKER.size(), TRUNCATED_MARKER.data(), TRUNCATED_MARKER.size());
+        }
+
+        pBuffer[size] = '\0';
+        LoggerImpl::Log(category, level, location, pBuffer);
+    }
+
+    Logger::AsyncOverflowCount Logger::GetAsyncOverflowCount()
+    {
+        AsyncOverflowCount result;
+        result.blocked = gAsyncBlockedCount.load(std::memory_order_relaxed);
+        result.droppedNewest = gAsyncDroppedNewestCount.load(std::memory_order_relaxed);
+        result.droppedOldest = gAsyncDroppedOldestCount.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    Logger::Statistics Logger::GetStatistics()
+    {
+        Statistics result;
+        {
+            std::lock_guard<std::mutex> guard(gStatisticsMutex);
+            std::copy(std::begin(gRetiredStatistics), std::end(gRetiredStatistics), result.levels);
+            for (const auto* pShard: gStatisticsShards)
+                AddStatistics(*pShard, result.levels);
+        }
+
+        result.asyncOverflow = GetAsyncOverflowCount();
+        result.queueHighWaterMark = gAsyncQueueHighWaterMark.load(std::memory_order_relaxed);
+        result.sinkCallCount = gSinkCallCount.load(std::memory_order_relaxed);
+        result.sinkTimeNs = gSinkTimeNs.load(std::memory_order_relaxed);
+        result.maxSinkTimeNs = gMaxSinkTimeNs.load(std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> guard(gAsyncControlMutex);
+            if (AsyncLogQueue* pQueue = gAsyncQueue.load(std::memory_order_acquire); pQueue != nullptr)
+                result.queueCapacity = pQueue->Capacity();
         }
+
+        return result;
+    }
+
+    void Logger::Log(Level level, const std::string& message, const std::source_location& location)
+    {
+        if (!IsEnabled(level))
+            return;
+
+        LoggerImpl::Log(DEFAULT_CATEGORY, level, location, message.c_str());
+    }
+
+    void Logger::Log(Level level, const char* message, const std::source_location& location)
+    {
+        if (!IsEnabled(level))
+            return;
+
+        LoggerImpl::Log(DEFAULT_CATEGORY, level, location, message);
+    }
+
+    void Logger::Log(const LogCategory& category, Level level, const std::string& message, const std::source_location& location)
+    {
+        if (!IsEnabled(category, level))
+            return;
+
+        LoggerImpl::Log(category, level, location, message.c_str());
+    }
+
+    void Logger::Log(const LogCategory& category, Level level, const char* message, const std::source_location& location)
+    {
+        if (!IsEnabled(category, level))
+            return;
+
+        LoggerImpl::Log(category, level, location, message);
+    }
+
+    void Logger::LogTrace(const std::string& message, const std::source_location& location)
+    {
+        if (!IsEnabled(Level::Trace))
+            return;
+
+        LogTrace(message.c_str(), location);
+    }
+
+    void Logger::LogTrace(const char* message, const std::source_location& location)
+    {
+        if (!IsEnabled(Level::Trace))
+            return;
+
+        LoggerImpl::Log(DEFAULT_CATEGORY, Level::Trace, location, message);
+    }
+
+    void Logger::LogDebug(const std::string& message, const std::source_location& location)
+    {
+        if (!IsEnabled(Level::Debug))
+            return;
+
+        LogDebug(message.c_str(), location);
+    }
+
+    void Logger::LogDebug(const char* message, const std::source_location& location)
+    {
+        if (!IsEnabled(Level::Debug))
+            return;
+
+        LoggerImpl::Log(DEFAULT_CATEGORY, Level::Debug, location, message);
+    }
+
+    void Logger::LogInfo(const std::string& message, const std::source_location& location)
+    {
+        if (!IsEnabled(Level::Info))
+            return;
+
+        LogInfo(message.c_str(), location);
+    }
+
+    void Logger::LogInfo(const char* message, const std::source_location& location)
+    {
+        if (!IsEnabled(Level::Info))
+            return;
+
+        LoggerImpl::Log(DEFAULT_CATEGORY, Level::Info, location, message);
+    }
+
+    void Logger::LogWarn(const std::string& message, const std::source_location& location)
+    {
+        if (!IsEnabled(Level::Warning))
+            return;
+
+        LogWarn(message.c_str(), location);
+    }
+
+    void Logger::LogWarn(const char* message, const std::source_location& location)
+    {
+        if (!IsEnabled(Level::Warning))
+            return;
+
+        LoggerImpl::Log(DEFAULT_CATEGORY, Level::Warning, location, message);
+    }
+
+    void Logger::LogError(const std::string& message, const std::source_location& location)
+    {
+        if (!IsEnabled(Level::Error))
+            return;
+
+        LogError(message.c_str(), location);
+    }
+
+    void Logger::LogError(const char* message, const std::source_location& location)
+    {
+        if (!IsEnabled(Level::Error))
+            return;
+
+        LoggerImpl::Log(DEFAULT_CATEGORY, Level::Error, location, message);
     }
 }
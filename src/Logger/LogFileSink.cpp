@@ -0,0 +1,401 @@
+#include <ctime>
+#include <cstring>
+#include <charconv>
+#include <string_view>
+#include <algorithm>
+#include <filesystem>
+#include "Infra/PlatformDefine.h"
+#include "Infra/Utility/LogFileSink.h"
+
+#if PLATFORM_WINDOWS
+#   include "Infra/Platform/Windows/WindowsDefine.h"
+#else
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <cerrno>
+#   include <sys/stat.h>
+#endif
+
+namespace Infra
+{
+    static constexpr intptr_t INVALID_FILE_HANDLE = -1;
+
+    // Upper bound of everything in a line except the message.
+    static constexpr size_t LINE_PREFIX_MAX_SIZE = Logger::TIMESTAMP_SIZE + 48;
+
+    // Open retry backoff in ns, doubled after each failure.
+    static constexpr int64_t OPEN_RETRY_MIN_DELAY = 100 * 1000000ll;
+    static constexpr int64_t OPEN_RETRY_MAX_DELAY = 30 * 1000000000ll;
+
+    static intptr_t OpenFileAppend(const std::string& path, uint64_t& fileSize)
+    {
+#if PLATFORM_WINDOWS
+        HANDLE handle = ::CreateFileW(std::filesystem::path(path).c_str(), FILE_APPEND_DATA,
+                                      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                      nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE)
+            return INVALID_FILE_HANDLE;
+
+        LARGE_INTEGER size {};
+        fileSize = ::GetFileSizeEx(handle, &size) ? static_cast<uint64_t>(size.QuadPart) : 0;
+        return reinterpret_cast<intptr_t>(handle);
+#else
+        const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0)
+            return INVALID_FILE_HANDLE;
+
+        struct stat fileStat {};
+        fileSize = ::fstat(fd, &fileStat) == 0 ? static_cast<uint64_t>(fileStat.st_size) : 0;
+        return fd;
+#endif
+    }
+
+    static bool WriteFileAll(intptr_t handle, const char* pData, size_t size)
+    {
+#if PLATFORM_WINDOWS
+        while (size > 0)
+        {
+            DWORD written = 0;
+            const DWORD toWrite = static_cast<DWORD>(std::min<size_t>(size, 0x40000000));
+            if (!::WriteFile(reinterpret_cast<HANDLE>(handle), pData, toWrite, &written, nullptr))
+                return false;
+
+            pData += written;
+            size -= written;
+        }
+#else
+        while (size > 0)
+        {
+            const ssize_t written = ::write(static_cast<int>(handle), pData, size);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                return false;
+            }
+
+            pData += written;
+            size -= static_cast<size_t>(written);
+        }
+#endif
+        return true;
+    }
+
+    static void SyncFile(intptr_t handle)
+    {
+#if PLATFORM_WINDOWS
+        ::FlushFileBuffers(reinterpret_cast<HANDLE>(handle));
+#elif PLATFORM_LINUX || PLATFORM_ANDROID
+        ::fdatasync(static_cast<int>(handle));
+#else
+        ::fsync(static_cast<int>(handle));
+#endif
+    }
+
+    static void CloseFileHandle(intptr_t handle)
+    {
+#if PLATFORM_WINDOWS
+        ::CloseHandle(reinterpret_cast<HANDLE>(handle));
+#else
+        ::close(static_cast<int>(handle));
+#endif
+    }
+
+    static std::string GetRotateTimeString(int64_t timestamp)
+    {
+        tm utcTime {};
+        const time_t second = static_cast<time_t>(timestamp / 1000000000);
+#if PLATFORM_WINDOWS
+        ::gmtime_s(&utcTime, &second);
+#else
+        ::gmtime_r(&second, &utcTime);
+#endif
+
+        char buffer[32];
+        const size_t size = std::strftime(buffer, sizeof(buffer), "%Y%m%d-%H%M%S", &utcTime);
+        return std::string(buffer, size);
+    }
+
+    static bool IsDigits(std::string_view str)
+    {
+        return !str.empty() && std::all_of(str.begin(), str.end(), [](char c) { return c >= '0' && c <= '9'; });
+    }
+
+    // <baseName>.<YYYYmmdd-HHMMSS>[-N].log as given by Rotate, files of other sinks in the
+    // directory such as <baseName>.audit.log never match.
+    static bool IsRotatedFileName(std::string_view name, std::string_view baseName)
+    {
+        constexpr size_t STAMP_SIZE = 15;
+        if (!name.starts_with(baseName) || !name.ends_with(".log"))
+            return false;
+
+        name = name.substr(baseName.size(), name.size() - baseName.size() - 4);
+        if (name.size() < STAMP_SIZE + 1 || name[0] != '.' || name[9] != '-')
+            return false;
+
+        if (!IsDigits(name.substr(1, 8)) || !IsDigits(name.substr(10, 6)))
+            return false;
+
+        name.remove_prefix(STAMP_SIZE + 1);
+        return name.empty() || (name[0] == '-' && IsDigits(name.substr(1)));
+    }
+
+    LogFileSink::LogFileSink(const Config& config)
+        : _config(config)
+        , _handle(INVALID_FILE_HANDLE)
+        , _fileSize(0)
+        , _nextRotateTime(INT64_MAX)
+        , _nextOpenTime(0)
+        , _openRetryDelay(OPEN_RETRY_MIN_DELAY)
+        , _bufferStartTime(0)
+    {
+        if (_config.bufferSize < LINE_PREFIX_MAX_SIZE * 2)
+            _config.bufferSize = LINE_PREFIX_MAX_SIZE * 2;
+
+        _filePath = (std::filesystem::path(_config.directory) / (_config.baseName + ".log")).string();
+        _buffer.reserve(_config.bufferSize);
+
+        std::lock_guard<std::mutex> guard(_mutex);
+        OpenFile();
+    }
+
+    LogFileSink::~LogFileSink()
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+        WriteBuffer();
+
+        if (_handle != INVALID_FILE_HANDLE && _config.syncPolicy != SyncPolicy::Never)
+            SyncFile(_handle);
+
+        CloseFile();
+    }
+
+    void LogFileSink::OnBatch(std::span<const LogRecord> records)
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+
+        for (const auto& record: records)
+            AppendRecord(record);
+
+        const int64_t maxDelay = static_cast<int64_t>(_config.maxBufferDelayMs) * 1000000;
+        if (!_buffer.empty() && !records.empty() && records.back().timestamp - _bufferStartTime >= maxDelay)
+            WriteBuffer();
+    }
+
+    void LogFileSink::OnTick(int64_t timestamp)
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+
+        const int64_t maxDelay = static_cast<int64_t>(_config.maxBufferDelayMs) * 1000000;
+        if (!_buffer.empty() && timestamp - _bufferStartTime >= maxDelay)
+            WriteBuffer();
+    }
+
+    void LogFileSink::OnFlush()
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+        WriteBuffer();
+
+        if (_handle != INVALID_FILE_HANDLE && _config.syncPolicy != SyncPolicy::Never)
+            SyncFile(_handle);
+    }
+
+    bool LogFileSink::IsOpen() const
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+        return _handle != INVALID_FILE_HANDLE;
+    }
+
+    std::string LogFileSink::GetFilePath() const
+    {
+        return _filePath;
+    }
+
+    void LogFileSink::AppendRecord(const LogRecord& record)
+    {
+        if (record.timestamp >= _nextRotateTime)
+        {
+            WriteBuffer();
+            Rotate();
+        }
+
+        const bool hasCategory = record.category->id != Logger::DEFAULT_CATEGORY.id;
+        const size_t categoryNameSize = hasCategory ? std::strlen(record.category->name) : 0;
+        const size_t lineMaxSize = LINE_PREFIX_MAX_SIZE + categoryNameSize + record.message.size();
+
+        if (_config.maxFileSize != 0)
+        {
+            const uint64_t pending = _fileSize + _buffer.size();
+            if (pending > 0 && pending + lineMaxSize > _config.maxFileSize)
+            {
+                WriteBuffer();
+                Rotate();
+            }
+        }
+
+        if (_buffer.size() + lineMaxSize > _config.bufferSize)
+            WriteBuffer();
+
+        if (_buffer.empty())
+            _bufferStartTime = record.timestamp;
+
+        // "<timestamp> [<LEVEL>] [<thread id>] [<category>] <message>\n", category only when not default
+        const size_t oldSize = _buffer.size();
+        _buffer.resize(oldSize + lineMaxSize);
+
+        char* pBegin = _buffer.data() + oldSize;
+        char* pEnd = _buffer.data() + _buffer.size();
+        char* p = pBegin;
+
+        p += Logger::FormatTimestamp(record.timestamp, p, Logger::TIMESTAMP_SIZE);
+
+        const char* levelName = Logger::GetLevelName(record.level);
+        const size_t levelNameSize = std::strlen(levelName);
+        *p++ = ' ';
+        *p++ = '[';
+        std::memcpy(p, levelName, levelNameSize);
+        p += levelNameSize;
+        *p++ = ']';
+        *p++ = ' ';
+        *p++ = '[';
+        p = std::to_chars(p, pEnd, record.threadId).ptr;
+        *p++ = ']';
+        *p++ = ' ';
+
+        if (hasCategory)
+        {
+            *p++ = '[';
+            std::memcpy(p, record.category->name, categoryNameSize);
+            p += categoryNameSize;
+            *p++ = ']';
+            *p++ = ' ';
+        }
+
+        std::memcpy(p, record.message.data(), record.message.size());
+        p += record.message.size();
+        *p++ = '\n';
+
+        _buffer.resize(oldSize + (p - pBegin));
+    }
+
+    bool LogFileSink::OpenFile()
+    {
+        const int64_t now = Logger::GetCoarseTimestamp();
+
+        // The directory may have been removed since the last open.
+        std::error_code errorCode;
+        std::filesystem::create_directories(_config.directory, errorCode);
+
+        _handle = OpenFileAppend(_filePath, _fileSize);
+        if (_handle == INVALID_FILE_HANDLE)
+        {
+            DelayReopen(now);
+            return false;
+        }
+
+        _openRetryDelay = OPEN_RETRY_MIN_DELAY;
+
+        if (_config.rotateIntervalSeconds != 0)
+        {
+            const int64_t interval = static_cast<int64_t>(_config.rotateIntervalSeconds) * 1000000000;
+            _nextRotateTime = (now / interval + 1) * interval;
+        }
+
+        return true;
+    }
+
+    void LogFileSink::DelayReopen(int64_t now)
+    {
+        _nextOpenTime = now + _openRetryDelay;
+        _openRetryDelay = std::min(_openRetryDelay * 2, OPEN_RETRY_MAX_DELAY);
+    }
+
+    void LogFileSink::CloseFile()
+    {
+        if (_handle == INVALID_FILE_HANDLE)
+            return;
+
+        CloseFileHandle(_handle);
+        _handle = INVALID_FILE_HANDLE;
+        _fileSize = 0;
+    }
+
+    void LogFileSink::WriteBuffer()
+    {
+        if (_buffer.empty())
+            return;
+
+        if (_handle == INVALID_FILE_HANDLE && Logger::GetCoarseTimestamp() >= _nextOpenTime)
+            OpenFile();
+
+        // Lines are dropped when the file can not be opened, keeping them would grow without bound.
+        if (_handle != INVALID_FILE_HANDLE)
+        {
+            if (WriteFileAll(_handle, _buffer.data(), _buffer.size()))
+            {
+                _fileSize += _buffer.size();
+                if (_config.syncPolicy == SyncPolicy::EveryWrite)
+                    SyncFile(_handle);
+            }
+            else
+            {
+                // Reopened after the backoff, the file may have been on a volume that went away.
+                CloseFile();
+                DelayReopen(Logger::GetCoarseTimestamp());
+            }
+        }
+
+        _buffer.clear();
+    }
+
+    void LogFileSink::Rotate()
+    {
+        if (_handle != INVALID_FILE_HANDLE && _config.syncPolicy != SyncPolicy::Never)
+            SyncFile(_handle);
+
+        CloseFile();
+
+        const std::filesystem::path directory(_config.directory);
+        const std::string prefix = _config.baseName + "." + GetRotateTimeString(Logger::GetCoarseTimestamp());
+
+        std::filesystem::path rotatedPath = directory / (prefix + ".log");
+        for (int index = 1; std::filesystem::exists(rotatedPath); index++)
+            rotatedPath = directory / (prefix + "-" + std::to_string(index) + ".log");
+
+        std::error_code errorCode;
+        std::filesystem::rename(_filePath, rotatedPath, errorCode);
+
+        OpenFile();
+        RemoveExpiredFiles();
+    }
+
+    void LogFileSink::RemoveExpiredFiles()
+    {
+        if (_config.maxFileCount == 0)
+            return;
+
+        std::error_code errorCode;
+        std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> rotatedFiles;
+        for (const auto& entry: std::filesystem::directory_iterator(_config.directory, errorCode))
+        {
+            if (!entry.is_regular_file(errorCode))
+                continue;
+
+            const std::string name = entry.path().filename().string();
+            if (!IsRotatedFileName(name, _config.baseName))
+                continue;
+
+            rotatedFiles.emplace_back(entry.last_write_time(errorCode), entry.path());
+        }
+
+        if (rotatedFiles.size() <= _config.maxFileCount)
+            return;
+
+        std::sort(rotatedFiles.begin(), rotatedFiles.end());
+
+        const size_t removeCount = rotatedFiles.size() - _config.maxFileCount;
+        for (size_t i = 0; i < removeCount; i++)
+            std::filesystem::remove(rotatedFiles[i].second, errorCode);
+    }
+}
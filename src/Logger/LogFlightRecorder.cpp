@@ -0,0 +1,308 @@
+#include <mutex>
+#include <cstring>
+#include <cstddef>
+#include <csignal>
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include "Infra/PlatformDefine.h"
+#include "Infra/System/Memory.h"
+#include "LogFlightRecorder.hpp"
+
+#if PLATFORM_WINDOWS
+#   include "Infra/Platform/Windows/WindowsDefine.h"
+#else
+#   include <signal.h>
+#endif
+
+namespace Infra
+{
+    static constexpr char FLIGHT_RECORDER_MAGIC[8] = { 'I', 'N', 'F', 'R', 'A', 'F', 'R', '1' };
+
+    // Everything in a line except the message, category names longer than this are cut.
+    static constexpr size_t CATEGORY_NAME_MAX_SIZE = 32;
+    static constexpr size_t LINE_PREFIX_MAX_SIZE = Logger::TIMESTAMP_SIZE + CATEGORY_NAME_MAX_SIZE + 48;
+
+    // Enough for the crash callback and the previous handler it passes the signal on to.
+    static constexpr size_t SIGNAL_STACK_SIZE = 64 * 1024;
+
+    std::unique_ptr<LogFlightRecorder> LogFlightRecorder::Create(const std::string& path, size_t fileSize)
+    {
+        if (fileSize < MIN_FILE_SIZE)
+            fileSize = MIN_FILE_SIZE;
+
+        void* pMapping = Memory::MapFile(path, fileSize);
+        if (pMapping == nullptr)
+            return nullptr;
+
+        return std::unique_ptr<LogFlightRecorder>(new LogFlightRecorder(pMapping, fileSize));
+    }
+
+    LogFlightRecorder::LogFlightRecorder(void* pMapping, size_t fileSize)
+        : _pMapping(pMapping)
+        , _fileSize(fileSize)
+        , _pHeader(static_cast<Header*>(pMapping))
+        , _pData(static_cast<char*>(pMapping) + HEADER_SIZE)
+        , _capacity(fileSize - HEADER_SIZE)
+    {
+        static_assert(sizeof(Header) <= HEADER_SIZE);
+        static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+        if (std::memcmp(_pHeader->magic, FLIGHT_RECORDER_MAGIC, sizeof(FLIGHT_RECORDER_MAGIC)) != 0
+            || _pHeader->capacity != _capacity)
+        {
+            ::new (_pHeader) Header {};
+            std::memcpy(_pHeader->magic, FLIGHT_RECORDER_MAGIC, sizeof(FLIGHT_RECORDER_MAGIC));
+            _pHeader->capacity = _capacity;
+            _pHeader->writePos.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    LogFlightRecorder::~LogFlightRecorder()
+    {
+        Memory::UnmapFile(_pMapping, _fileSize);
+    }
+
+    void LogFlightRecorder::Write(const LogRecord& record)
+    {
+        WriteLine(record, false);
+    }
+
+    void LogFlightRecorder::WriteInSignalHandler(const LogRecord& record)
+    {
+        WriteLine(record, true);
+    }
+
+    void LogFlightRecorder::WriteLine(const LogRecord& record, bool rawTimestamp)
+    {
+        // "<timestamp> [<LEVEL>] [<thread id>] [<category>] <message>\n", category only when not default.
+        // Everything below but FormatTimestamp is plain stores and to_chars, which a signal handler may use.
+        char prefix[LINE_PREFIX_MAX_SIZE];
+        char* p = prefix;
+        char* pEnd = prefix + sizeof(prefix);
+
+        if (rawTimestamp)
+            p = std::to_chars(p, p + Logger::TIMESTAMP_SIZE, record.timestamp).ptr;
+        else
+            p += Logger::FormatTimestamp(record.timestamp, p, Logger::TIMESTAMP_SIZE);
+
+        const char* levelName = Logger::GetLevelName(record.level);
+        const size_t levelNameSize = std::strlen(levelName);
+        *p++ = ' ';
+        *p++ = '[';
+        std::memcpy(p, levelName, levelNameSize);
+        p += levelNameSize;
+        *p++ = ']';
+        *p++ = ' ';
+        *p++ = '[';
+        p = std::to_chars(p, pEnd, record.threadId).ptr;
+        *p++ = ']';
+        *p++ = ' ';
+
+        if (record.category->id != Logger::DEFAULT_CATEGORY.id)
+        {
+            const size_t categoryNameSize = std::min(std::strlen(record.category->name), CATEGORY_NAME_MAX_SIZE);
+            *p++ = '[';
+            std::memcpy(p, record.category->name, categoryNameSize);
+            p += categoryNameSize;
+            *p++ = ']';
+            *p++ = ' ';
+        }
+
+        const size_t prefixSize = p - prefix;
+
+        // One line never takes more than half of the ring, so the previous line stays readable.
+        const size_t messageSize = std::min<uint64_t>(record.message.size(), _capacity / 2 - prefixSize - 1);
+        const size_t lineSize = prefixSize + messageSize + 1;
+
+        const uint64_t pos = _pHeader->writePos.fetch_add(lineSize, std::memory_order_relaxed);
+        Copy(pos, prefix, prefixSize);
+        Copy(pos + prefixSize, record.message.data(), messageSize);
+        Copy(pos + prefixSize + messageSize, "\n", 1);
+    }
+
+    void LogFlightRecorder::Copy(uint64_t pos, const char* pData, size_t size)
+    {
+        while (size > 0)
+        {
+            const uint64_t offset = pos % _capacity;
+            const size_t chunk = static_cast<size_t>(std::min<uint64_t>(size, _capacity - offset));
+            std::memcpy(_pData + offset, pData, chunk);
+
+            pos += chunk;
+            pData += chunk;
+            size -= chunk;
+        }
+    }
+
+    std::string LogFlightRecorder::ReadFile(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return {};
+
+        const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (content.size() < HEADER_SIZE || std::memcmp(content.data(), FLIGHT_RECORDER_MAGIC, sizeof(FLIGHT_RECORDER_MAGIC)) != 0)
+            return {};
+
+        uint64_t capacity = 0;
+        uint64_t writePos = 0;
+        std::memcpy(&capacity, content.data() + offsetof(Header, capacity), sizeof(capacity));
+        std::memcpy(&writePos, content.data() + offsetof(Header, writePos), sizeof(writePos));
+        if (capacity != content.size() - HEADER_SIZE)
+            return {};
+
+        const char* pData = content.data() + HEADER_SIZE;
+
+        std::string result;
+        if (writePos <= capacity)
+            result.assign(pData, static_cast<size_t>(writePos));
+        else
+        {
+            const size_t start = static_cast<size_t>(writePos % capacity);
+            result.assign(pData + start, static_cast<size_t>(capacity) - start);
+            result.append(pData, start);
+
+            const size_t firstLineEnd = result.find('\n');
+            result.erase(0, firstLineEnd == std::string::npos ? result.size() : firstLineEnd + 1);
+        }
+
+        // Space reserved by a writer that never finished is left as zero bytes.
+        std::erase(result, '\0');
+        return result;
+    }
+
+    static std::atomic<LogFlightRecorder::CrashCallback> gCrashCallback = nullptr;
+    static std::atomic<bool> gCrashHandled = false;
+
+    static void RunCrashCallback()
+    {
+        // Only the first crash is recorded, a fault inside the callback must not recurse.
+        if (gCrashHandled.exchange(true))
+            return;
+
+        if (const auto pCallback = gCrashCallback.load(std::memory_order_acquire); pCallback != nullptr)
+            pCallback();
+    }
+
+#if PLATFORM_WINDOWS
+    static LPTOP_LEVEL_EXCEPTION_FILTER gPrevExceptionFilter = nullptr;
+    static void (*gPrevAbortHandler)(int) = SIG_DFL;
+
+    static LONG WINAPI CrashExceptionFilter(EXCEPTION_POINTERS* pExceptionInfo)
+    {
+        RunCrashCallback();
+        return gPrevExceptionFilter != nullptr ? gPrevExceptionFilter(pExceptionInfo) : EXCEPTION_CONTINUE_SEARCH;
+    }
+
+    static void CrashAbortHandler(int signal)
+    {
+        RunCrashCallback();
+        std::signal(signal, gPrevAbortHandler);
+        std::raise(signal);
+    }
+
+    static void InstallPlatformCrashHandler()
+    {
+        gPrevExceptionFilter = ::SetUnhandledExceptionFilter(CrashExceptionFilter);
+        gPrevAbortHandler = std::signal(SIGABRT, CrashAbortHandler);
+    }
+
+    void LogFlightRecorder::InstallSignalStack()
+    {
+        // Stack kept back for the exception filter after EXCEPTION_STACK_OVERFLOW.
+        static thread_local bool tInstalled = false;
+        if (tInstalled)
+            return;
+
+        ULONG size = SIGNAL_STACK_SIZE;
+        ::SetThreadStackGuarantee(&size);
+        tInstalled = true;
+    }
+#else
+    static constexpr int CRASH_SIGNALS[] = { SIGSEGV, SIGABRT, SIGBUS, SIGFPE, SIGILL };
+    static struct sigaction gPrevCrashActions[std::size(CRASH_SIGNALS)];
+
+    static void CrashSignalHandler(int signal)
+    {
+        RunCrashCallback();
+
+        // Restore the previous action, the signal is blocked inside the handler so raise
+        // delivers it to that action right after return. A fault is also raised again by
+        // the faulting instruction itself.
+        for (size_t i = 0; i < std::size(CRASH_SIGNALS); i++)
+        {
+            if (CRASH_SIGNALS[i] == signal)
+                ::sigaction(signal, &gPrevCrashActions[i], nullptr);
+        }
+
+        ::raise(signal);
+    }
+
+    static void InstallPlatformCrashHandler()
+    {
+        struct sigaction action {};
+        action.sa_handler = CrashSignalHandler;
+        action.sa_flags = SA_ONSTACK;
+        ::sigemptyset(&action.sa_mask);
+
+        for (size_t i = 0; i < std::size(CRASH_SIGNALS); i++)
+            ::sigaction(CRASH_SIGNALS[i], &action, &gPrevCrashActions[i]);
+    }
+
+    // Alternate stack of one thread, disabled again before the memory is freed at thread exit.
+    class SignalStack : public NonCopyable
+    {
+    public:
+        SignalStack()
+        {
+            stack_t current {};
+            if (::sigaltstack(nullptr, &current) != 0 || (current.ss_flags & SS_DISABLE) == 0)
+                return;
+
+            const size_t size = std::max<size_t>(SIGSTKSZ, SIGNAL_STACK_SIZE);
+            _pMemory = std::make_unique<char[]>(size);
+
+            stack_t stack {};
+            stack.ss_sp = _pMemory.get();
+            stack.ss_size = size;
+            if (::sigaltstack(&stack, nullptr) != 0)
+                _pMemory.reset();
+        }
+
+        ~SignalStack()
+        {
+            if (_pMemory == nullptr)
+                return;
+
+            // Somebody else may have replaced ours in the meantime, leave theirs alone.
+            stack_t current {};
+            if (::sigaltstack(nullptr, &current) == 0 && current.ss_sp == _pMemory.get())
+            {
+                stack_t disable {};
+                disable.ss_flags = SS_DISABLE;
+                ::sigaltstack(&disable, nullptr);
+            }
+        }
+
+    private:
+        std::unique_ptr<char[]> _pMemory;
+    };
+
+    void LogFlightRecorder::InstallSignalStack()
+    {
+        static thread_local SignalStack tSignalStack;
+        (void)tSignalStack;
+    }
+#endif
+
+    void LogFlightRecorder::InstallCrashHandler(CrashCallback pCallback)
+    {
+        gCrashCallback.store(pCallback, std::memory_order_release);
+        InstallSignalStack();
+
+        static std::once_flag installFlag;
+        std::call_once(installFlag, InstallPlatformCrashHandler);
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include "Infra/Utility/Logger.h"
+#include "Infra/Utility/NonCopyable.h"
+
+namespace Infra
+{
+    /* Text ring buffer in a memory mapped file. Writers reserve space with one atomic add and
+     * copy the line in with plain stores, no syscall and no lock. Dirty pages belong to the
+     * page cache, so the content reaches the file even when the process is killed.
+     * A new recorder on an existing file with the same size continues after its last line.
+     */
+    class LogFlightRecorder : public NonCopyable
+    {
+    public:
+        using CrashCallback = void(*)();
+
+        static constexpr size_t MIN_FILE_SIZE = 4096;
+
+    public:
+        static std::unique_ptr<LogFlightRecorder> Create(const std::string& path, size_t fileSize);
+        ~LogFlightRecorder();
+
+    public:
+        // Timestamp is formatted in local time with Logger::FormatTimestamp, not for signal handlers.
+        void Write(const LogRecord& record);
+
+        // Async signal safe variant for the crash path, the timestamp is written as raw nanoseconds
+        // since epoch, so no time zone, locale or thread local state is touched.
+        void WriteInSignalHandler(const LogRecord& record);
+
+        // Lines of a recorder file oldest first, the line cut by wrap around is dropped.
+        static std::string ReadFile(const std::string& path);
+
+        // Call pCallback once on SIGSEGV, SIGABRT, SIGBUS, SIGFPE and SIGILL (unhandled SEH exception
+        // and SIGABRT on windows), then pass the crash to the previous handler. Installed only once.
+        static void InstallCrashHandler(CrashCallback pCallback);
+
+        // Give the calling thread an alternate signal stack, so the crash handler still runs after a
+        // stack overflow. Threads which already have one keep it. Called by InstallCrashHandler for
+        // the installing thread, other threads that may crash call it themselves.
+        static void InstallSignalStack();
+
+    private:
+        struct Header
+        {
+            char magic[8];
+            uint64_t capacity;
+            std::atomic<uint64_t> writePos;
+        };
+
+        static constexpr size_t HEADER_SIZE = 64;
+
+        LogFlightRecorder(void* pMapping, size_t fileSize);
+
+        void WriteLine(const LogRecord& record, bool rawTimestamp);
+        void Copy(uint64_t pos, const char* pData, size_t size);
+
+    private:
+        void* _pMapping;
+        size_t _fileSize;
+        Header* _pHeader;
+        char* _pData;
+        uint64_t _capacity;
+    };
+}
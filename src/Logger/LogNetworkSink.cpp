@@ -0,0 +1,259 @@
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include "Infra/Utility/LogNetworkSink.h"
+
+namespace Infra
+{
+    // Size prefix, level, category id, timestamp, thread id, category name size.
+    static constexpr size_t FRAME_HEADER_SIZE = 4 + 1 + 2 + 8 + 8 + 2;
+
+    static int64_t SteadyNowMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static char* WriteBigEndian(char* p, uint64_t value, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+            p[i] = static_cast<char>(value >> ((size - 1 - i) * 8));
+
+        return p + size;
+    }
+
+    static uint32_t ReadFrameSize(const char* p)
+    {
+        const auto* pByte = reinterpret_cast<const unsigned char*>(p);
+        return (static_cast<uint32_t>(pByte[0]) << 24) | (static_cast<uint32_t>(pByte[1]) << 16)
+            | (static_cast<uint32_t>(pByte[2]) << 8) | static_cast<uint32_t>(pByte[3]);
+    }
+
+    LogNetworkSink::LogNetworkSink(const EndPoint& endpoint)
+        : LogNetworkSink(endpoint, Config{})
+    {
+    }
+
+    LogNetworkSink::LogNetworkSink(const EndPoint& endpoint, const Config& config)
+        : _endpoint(endpoint)
+        , _config(config)
+        , _backlogRecords(0)
+        , _sendingBusy(false)
+        , _stop(false)
+        , _sendingOffset(0)
+        , _sendingRecords(0)
+        , _reconnectDelayMs(config.minReconnectDelayMs)
+        , _nextConnectTime(0)
+        , _sentRecords(0)
+        , _droppedRecords(0)
+        , _connectCount(0)
+        , _connected(false)
+    {
+        _sender = std::thread(&LogNetworkSink::SenderLoop, this);
+    }
+
+    LogNetworkSink::~LogNetworkSink()
+    {
+        OnFlush();
+
+        {
+            std::lock_guard<std::mutex> guard(_mutex);
+            _stop = true;
+        }
+
+        _wakeCondition.notify_all();
+        _sender.join();
+
+        if (_socket.has_value())
+            _socket->Close();
+    }
+
+    void LogNetworkSink::OnBatch(std::span<const LogRecord> records)
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+
+        for (const auto& record: records)
+        {
+            const size_t nameSize = std::min<size_t>(std::strlen(record.category->name), UINT16_MAX);
+            const size_t frameSize = FRAME_HEADER_SIZE + nameSize + record.message.size();
+            if (_backlog.size() + frameSize > _config.maxBacklogSize || frameSize > UINT32_MAX)
+            {
+                _droppedRecords.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            const size_t oldSize = _backlog.size();
+            _backlog.resize(oldSize + frameSize);
+
+            char* p = _backlog.data() + oldSize;
+            p = WriteBigEndian(p, frameSize - 4, 4);
+            p = WriteBigEndian(p, static_cast<uint64_t>(record.level), 1);
+            p = WriteBigEndian(p, record.category->id, 2);
+            p = WriteBigEndian(p, static_cast<uint64_t>(record.timestamp), 8);
+            p = WriteBigEndian(p, record.threadId, 8);
+            p = WriteBigEndian(p, nameSize, 2);
+            std::memcpy(p, record.category->name, nameSize);
+            std::memcpy(p + nameSize, record.message.data(), record.message.size());
+
+            _backlogRecords++;
+        }
+
+        // Sender picks the backlog up on its next interval unless it grows large.
+        if (_backlog.size() >= _config.sendChunkSize)
+            _wakeCondition.notify_one();
+    }
+
+    void LogNetworkSink::OnFlush()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _wakeCondition.notify_one();
+        _idleCondition.wait_for(lock, std::chrono::milliseconds(_config.flushTimeoutMs), [this]() -> bool
+        {
+            return _stop || (_backlog.empty() && !_sendingBusy);
+        });
+    }
+
+    LogNetworkSink::Statistics LogNetworkSink::GetStatistics() const
+    {
+        Statistics result;
+        result.sentRecords = _sentRecords.load(std::memory_order_relaxed);
+        result.droppedRecords = _droppedRecords.load(std::memory_order_relaxed);
+        result.connectCount = _connectCount.load(std::memory_order_relaxed);
+        result.connected = _connected.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    void LogNetworkSink::SenderLoop()
+    {
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+
+                if (_sendingOffset == _sending.size())
+                {
+                    _sentRecords.fetch_add(_sendingRecords, std::memory_order_relaxed);
+                    _sending.clear();
+                    _sendingOffset = 0;
+                    _sendingRecords = 0;
+
+                    // Swap keeps both buffers' capacity, steady state does not allocate.
+                    _sending.swap(_backlog);
+                    _sendingRecords = _backlogRecords;
+                    _backlogRecords = 0;
+                    _sendingBusy = !_sending.empty();
+
+                    if (!_sendingBusy)
+                    {
+                        _idleCondition.notify_all();
+                        if (_stop)
+                            break;
+
+                        _wakeCondition.wait_for(lock, std::chrono::milliseconds(_config.sendIntervalMs), [this]() -> bool
+                        {
+                            return _stop || !_backlog.empty();
+                        });
+                        continue;
+                    }
+                }
+                else if (_stop)
+                    break;
+            }
+
+            if (SendPending())
+                continue;
+
+            // Not connected, sleep until the next connect attempt.
+            std::unique_lock<std::mutex> lock(_mutex);
+            const int64_t waitMs = std::clamp<int64_t>(_nextConnectTime - SteadyNowMs(), 1, _config.sendIntervalMs);
+            _wakeCondition.wait_for(lock, std::chrono::milliseconds(waitMs), [this]() -> bool { return _stop; });
+        }
+
+        _connected.store(false, std::memory_order_relaxed);
+    }
+
+    bool LogNetworkSink::TryConnect()
+    {
+        const int64_t now = SteadyNowMs();
+        if (now < _nextConnectTime)
+            return false;
+
+        std::optional<TcpSocket> socket = TcpSocket::Create(_endpoint.GetAddressFamily());
+        if (socket.has_value())
+        {
+            if (socket->Connect(_endpoint, static_cast<int>(_config.connectTimeoutMs)) == SocketState::Success
+                && socket->SetBlocking(false))
+            {
+                _socket = std::move(socket);
+                _reconnectDelayMs = _config.minReconnectDelayMs;
+                _connectCount.fetch_add(1, std::memory_order_relaxed);
+                _connected.store(true, std::memory_order_relaxed);
+                return true;
+            }
+
+            socket->Close();
+        }
+
+        _nextConnectTime = now + _reconnectDelayMs;
+        _reconnectDelayMs = std::min(std::max<uint32_t>(_reconnectDelayMs, 1) * 2, _config.maxReconnectDelayMs);
+        return false;
+    }
+
+    bool LogNetworkSink::SendPending()
+    {
+        if (!_socket.has_value() && !TryConnect())
+            return false;
+
+        while (_sendingOffset < _sending.size())
+        {
+            const size_t size = std::min(_sending.size() - _sendingOffset, _config.sendChunkSize);
+            const auto [state, sent] = _socket->Send(_sending.data() + _sendingOffset, size);
+
+            if (state == SocketState::Success)
+            {
+                _sendingOffset += sent;
+                continue;
+            }
+
+            if (state == SocketState::Busy)
+            {
+                // Kernel buffer is full, wait for room without holding any lock.
+                _socket->SelectWrite(static_cast<int>(_config.sendIntervalMs));
+                return true;
+            }
+
+            _socket->Close();
+            _socket.reset();
+            _connected.store(false, std::memory_order_relaxed);
+            DropPartialFrame();
+            return false;
+        }
+
+        return true;
+    }
+
+    void LogNetworkSink::DropPartialFrame()
+    {
+        // Resend from a frame boundary on the next connection, a partially sent frame is lost.
+        size_t frameStart = 0;
+        size_t removedFrames = 0;
+        while (frameStart < _sendingOffset)
+        {
+            const size_t frameEnd = frameStart + 4 + ReadFrameSize(_sending.data() + frameStart);
+            if (frameEnd > _sendingOffset)
+            {
+                _droppedRecords.fetch_add(1, std::memory_order_relaxed);
+                removedFrames++;
+                frameStart = frameEnd;
+                break;
+            }
+
+            _sentRecords.fetch_add(1, std::memory_order_relaxed);
+            removedFrames++;
+            frameStart = frameEnd;
+        }
+
+        _sending.erase(_sending.begin(), _sending.begin() + static_cast<std::ptrdiff_t>(frameStart));
+        _sendingOffset = 0;
+        _sendingRecords -= removedFrames;
+    }
+}
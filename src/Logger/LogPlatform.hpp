@@ -0,0 +1,91 @@
+#pragma once
+
+#include <ctime>
+#include <chrono>
+#include <cstdint>
+#include "Infra/PlatformDefine.h"
+
+#if PLATFORM_WINDOWS
+#   include "Infra/Platform/Windows/WindowsDefine.h"
+#elif PLATFORM_LINUX || PLATFORM_ANDROID
+#   include <unistd.h>
+#   include <sys/syscall.h>
+#   include <linux/membarrier.h>
+#elif PLATFORM_SUPPORT_POSIX
+#   include <pthread.h>
+#endif
+
+namespace Infra
+{
+    class LogPlatform
+    {
+    public:
+        LogPlatform() = delete;
+
+    public:
+        // Nanoseconds since unix epoch, resolution is the scheduler tick where a coarse clock exists.
+        static int64_t CoarseTimestamp()
+        {
+#if PLATFORM_LINUX || PLATFORM_ANDROID
+            timespec ts {};
+            ::clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+            return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#elif PLATFORM_WINDOWS
+            // FILETIME is 100ns since 1601-01-01.
+            ::FILETIME fileTime;
+            ::GetSystemTimeAsFileTime(&fileTime);
+            const uint64_t ticks = (static_cast<uint64_t>(fileTime.dwHighDateTime) << 32) | fileTime.dwLowDateTime;
+            return static_cast<int64_t>(ticks - 116444736000000000ULL) * 100;
+#else
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+#endif
+        }
+
+        static uint64_t CurrentThreadId()
+        {
+#if PLATFORM_WINDOWS
+            return ::GetCurrentThreadId();
+#elif PLATFORM_LINUX || PLATFORM_ANDROID
+            return static_cast<uint64_t>(::syscall(SYS_gettid));
+#elif PLATFORM_SUPPORT_POSIX
+            uint64_t id = 0;
+            ::pthread_threadid_np(nullptr, &id);
+            return id;
+#else
+            return 0;
+#endif
+        }
+
+        // Allow ProcessBarrier in this process, false when the platform or kernel has none.
+        static bool RegisterProcessBarrier()
+        {
+#if PLATFORM_WINDOWS
+            return true;
+#elif PLATFORM_LINUX || PLATFORM_ANDROID
+            return ::syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) == 0;
+#else
+            return false;
+#endif
+        }
+
+        // Full memory barrier on every running thread of the process, only valid after a
+        // successful RegisterProcessBarrier.
+        static void ProcessBarrier()
+        {
+#if PLATFORM_WINDOWS
+            ::FlushProcessWriteBuffers();
+#elif PLATFORM_LINUX || PLATFORM_ANDROID
+            ::syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0);
+#endif
+        }
+
+        static bool LocalTime(time_t time, tm& result)
+        {
+#if PLATFORM_WINDOWS
+            return ::localtime_s(&result, &time) == 0;
+#else
+            return ::localtime_r(&time, &result) != nullptr;
+#endif
+        }
+    };
+}
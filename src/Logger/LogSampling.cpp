@@ -0,0 +1,105 @@
+#include <string>
+#include <algorithm>
+#include "Infra/Utility/LogSampling.h"
+
+namespace Infra
+{
+    // Sites which suppressed at least once, pushed at the head and never removed.
+    static std::atomic<LogRateLimiter*> gListedRateLimiters = nullptr;
+
+    void LogRateLimiter::ReportSuppressed(Logger::Level level, uint64_t count, const std::source_location& location)
+    {
+        const std::string message = "Suppressed " + std::to_string(count) + " messages from this call site";
+        Logger::Log(level, message, location);
+    }
+
+    bool LogRateLimiter::TryPass(uint64_t seen, uint64_t& suppressed)
+    {
+        // Passing is rare, the clock is read here and refreshes the cached one for rejected calls.
+        const uint64_t now = static_cast<uint64_t>(Logger::RefreshCachedTimestamp()) / TICK_NS;
+
+        uint64_t state = _state.load(std::memory_order_relaxed);
+        while (true)
+        {
+            // Every pass and summary moves the arrival time. If it moved since our add, a summary
+            // or another pass has taken our add as suppressed, so this call is suppressed too.
+            if ((state >> COUNT_BITS) != (seen >> COUNT_BITS))
+                return false;
+
+            const uint64_t arrival = std::max(state >> COUNT_BITS, now) + _interval;
+            if (_state.compare_exchange_weak(state, arrival << COUNT_BITS, std::memory_order_relaxed))
+                break;
+        }
+
+        // The count includes our own add.
+        const uint64_t total = (state & COUNT_MASK) + _spilled.exchange(0, std::memory_order_relaxed);
+        suppressed = total > 0 ? total - 1 : 0;
+        return true;
+    }
+
+    void LogRateLimiter::OnSuppressed(uint64_t count)
+    {
+        if (count == COUNT_SPILL)
+        {
+            uint64_t state = _state.load(std::memory_order_relaxed);
+            while ((state & COUNT_MASK) >= COUNT_SPILL)
+            {
+                if (_state.compare_exchange_weak(state, state - COUNT_SPILL, std::memory_order_relaxed))
+                {
+                    _spilled.fetch_add(COUNT_SPILL, std::memory_order_relaxed);
+                    break;
+                }
+            }
+
+            return;
+        }
+
+        if (!_listed.load(std::memory_order_relaxed) && !_listed.exchange(true, std::memory_order_relaxed))
+        {
+            _pNextListed = gListedRateLimiters.load(std::memory_order_relaxed);
+            while (!gListedRateLimiters.compare_exchange_weak(_pNextListed, this, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        Logger::WakeSuppressionReport();
+    }
+
+    bool LogRateLimiter::ReportIfOpen(uint64_t now, bool force)
+    {
+        uint64_t state = _state.load(std::memory_order_relaxed);
+        while (true)
+        {
+            if ((state & COUNT_MASK) == 0 && _spilled.load(std::memory_order_relaxed) == 0)
+                return false;
+
+            if (!force && now + _tolerance < (state >> COUNT_BITS))
+                return true;
+
+            // The summary takes the slot of one message, which also tells racing passes that their add was counted.
+            const uint64_t arrival = std::max(state >> COUNT_BITS, now) + _interval;
+            if (_state.compare_exchange_weak(state, arrival << COUNT_BITS, std::memory_order_relaxed))
+                break;
+        }
+
+        const uint64_t count = (state & COUNT_MASK) + _spilled.exchange(0, std::memory_order_relaxed);
+        if (count > 0)
+            ReportSuppressed(_level, count, _location);
+
+        return false;
+    }
+
+    bool LogRateLimiter::ReportPending(bool force)
+    {
+        const uint64_t now = static_cast<uint64_t>(Logger::GetCachedTimestamp()) / TICK_NS;
+
+        bool pending = false;
+        for (LogRateLimiter* p = gListedRateLimiters.load(std::memory_order_acquire); p != nullptr; p = p->_pNextListed)
+        {
+            if (p->ReportIfOpen(now, force))
+                pending = true;
+        }
+
+        return pending;
+    }
+}
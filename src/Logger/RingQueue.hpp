@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include "Infra/Utility/NonCopyable.h"
+
+namespace Infra
+{
+    /* Bounded lock-free ring queue (Dmitry Vyukov's sequence-per-cell design).
+     * Logger uses it as a MPSC queue, but pop is also safe from producers, which
+     * is what the drop-oldest overflow policy relies on.
+     * Cells are preallocated, push/pop construct and consume the element in place.
+     */
+    template <typename T>
+    class RingQueue : public NonCopyable
+    {
+    public:
+        static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    public:
+        explicit RingQueue(size_t capacity)
+            : _capacity(RoundUpPowerOfTwo(capacity < 2 ? 2 : capacity))
+            , _mask(_capacity - 1)
+            , _cells(new Cell[_capacity])
+        {
+            for (size_t i = 0; i < _capacity; i++)
+                _cells[i].sequence.store(i, std::memory_order_relaxed);
+
+            _enqueuePos.store(0, std::memory_order_relaxed);
+            _dequeuePos.store(0, std::memory_order_relaxed);
+        }
+
+        size_t Capacity() const
+        {
+            return _capacity;
+        }
+
+        // Position of the next push, every successful push advances it by one.
+        size_t EnqueuePosition() const
+        {
+            return _enqueuePos.load(std::memory_order_acquire);
+        }
+
+        // Position of the next pop, every successful pop advances it by one.
+        size_t DequeuePosition() const
+        {
+            return _dequeuePos.load(std::memory_order_acquire);
+        }
+
+        bool Empty() const
+        {
+            return DequeuePosition() >= EnqueuePosition();
+        }
+
+        // fill(T&) is called on the reserved cell, return false when queue is full.
+        // The cell is published even if fill throws, so fill must leave it consumable.
+        template <typename Fill>
+        bool TryPush(Fill&& fill)
+        {
+            size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+            Cell* pCell;
+
+            while (true)
+            {
+                pCell = &_cells[pos & _mask];
+                const size_t seq = pCell->sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+                if (diff == 0)
+                {
+                    if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                    return false;
+                else
+                    pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+
+            // An unpublished cell would stall every later pop.
+            try
+            {
+                fill(pCell->data);
+            }
+            catch (...)
+            {
+                pCell->sequence.store(pos + 1, std::memory_order_release);
+                throw;
+            }
+
+            pCell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        // consume(T&) is called on the popped cell, return false when queue is empty.
+        template <typename Consume>
+        bool TryPop(Consume&& consume)
+        {
+            size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+            Cell* pCell;
+
+            while (true)
+            {
+                pCell = &_cells[pos & _mask];
+                const size_t seq = pCell->sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+
+                if (diff == 0)
+                {
+                    if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                    return false;
+                else
+                    pos = _dequeuePos.load(std::memory_order_relaxed);
+            }
+
+            consume(pCell->data);
+            pCell->sequence.store(pos + _mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        // visit(const T&) on every published cell not yet popped, without consuming them.
+        // Only meant for crash handling, cells may be popped and reused while being visited.
+        template <typename Visit>
+        void PeekPending(Visit&& visit) const
+        {
+            const size_t enqueuePos = _enqueuePos.load(std::memory_order_acquire);
+            for (size_t pos = _dequeuePos.load(std::memory_order_acquire); pos < enqueuePos; pos++)
+            {
+                const Cell& cell = _cells[pos & _mask];
+                if (cell.sequence.load(std::memory_order_acquire) == pos + 1)
+                    visit(cell.data);
+            }
+        }
+
+    private:
+        static size_t RoundUpPowerOfTwo(size_t value)
+        {
+            size_t result = 1;
+            while (result < value)
+                result <<= 1;
+
+            return result;
+        }
+
+    private:
+        struct alignas(CACHE_LINE_SIZE) Cell
+        {
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+        const size_t _capacity;
+        const size_t _mask;
+        std::unique_ptr<Cell[]> _cells;
+
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> _enqueuePos;
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> _dequeuePos;
+    };
+}
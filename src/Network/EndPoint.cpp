@@ -3,6 +3,18 @@
 
 namespace Infra
 {
+    EndPoint::EndPoint(const IpAddress& ip, uint16_t port)
+        : EndPoint(ip, port, 0)
+    {
+    }
+
+    EndPoint::EndPoint(const IpAddress& ip, uint16_t port, uint32_t scopeId)
+        : _ip(ip)
+        , _port(port)
+        , _v6ScopeId(scopeId)
+    {
+    }
+
     const IpAddress& EndPoint::GetIp() const
     {
         return _ip;
@@ -2,21 +2,13 @@
 
 #if PLATFORM_SUPPORT_POSIX
 
+#include <cerrno>
+
 namespace Infra::Device
 {
-    SocketHandle ToNativeHandle(void* handle)
-    {
-        return reinterpret_cast<SocketHandle>(handle);
-    }
-
-    void* ToGeneralHandle(SocketHandle sock)
-    {
-        return reinterpret_cast<void*>(sock);
-    }
-
     SocketHandle GetInvalidSocket()
     {
-        return 0;
+        return -1;
     }
 
     void CloseSocket(void* handle)
@@ -44,7 +36,36 @@ namespace Infra::Device
         return true;
     }
 
-
+    SocketState GetErrorState()
+    {
+        switch (errno)
+        {
+            // Non-blocking socket would block, send buffer is full or no data yet.
+            case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+            case EWOULDBLOCK:
+#endif
+            // Non-blocking connect started or is still in progress.
+            case EINPROGRESS:
+            case EALREADY:
+            // Interrupted by a signal, caller can retry.
+            case EINTR:
+                return SocketState::Busy;
+            // Connection reset, aborted, timed out or closed by the peer.
+            case ECONNRESET:
+            case ECONNABORTED:
+            case ETIMEDOUT:
+            case ENETRESET:
+            case ENOTCONN:
+            case EPIPE:
+                return SocketState::Disconnect;
+            // Socket is already connected.
+            case EISCONN:
+                return SocketState::Success;
+            default:
+                return SocketState::Error;
+        }
+    }
 }
 
 #endif
@@ -6,6 +6,7 @@
 
 #include "Infra/Network/SocketState.h"
 
+#include <cstdint>
 #include <netdb.h>
 #include <arpa/inet.h>
 #include <sys/ioctl.h>
@@ -15,20 +16,29 @@
 namespace Infra
 {
     using SocketHandle = int;
+    using SocketLength = socklen_t;
 
     namespace Device
     {
         INFRA_FORCE_INLINE
-        SocketHandle ToNativeHandle(void* handle);
+        SocketHandle ToNativeHandle(void* handle)
+        {
+            return static_cast<SocketHandle>(reinterpret_cast<intptr_t>(handle));
+        }
 
         INFRA_FORCE_INLINE
-        void* ToGeneralHandle(SocketHandle sock);
-        
+        void* ToGeneralHandle(SocketHandle sock)
+        {
+            return reinterpret_cast<void*>(static_cast<intptr_t>(sock));
+        }
+
         SocketHandle GetInvalidSocket();
 
         void CloseSocket(void* handle);
 
         bool SetSocketBlocking(void* handle, bool block);
+
+        SocketState GetErrorState();
     }
 }
 
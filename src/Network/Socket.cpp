@@ -27,7 +27,20 @@ namespace Infra
         if (!force && block == IsBlocking())
             return true;
 
-        return Device::SetSocketBlocking(_handle, block);
+        if (!Device::SetSocketBlocking(_handle, block))
+            return false;
+
+        _isBlocking = block;
+        return true;
+    }
+
+    void Socket::Close()
+    {
+        if (Device::ToNativeHandle(_handle) == Device::GetInvalidSocket())
+            return;
+
+        Device::CloseSocket(_handle);
+        _handle = Device::ToGeneralHandle(Device::GetInvalidSocket());
     }
 
     SocketState Socket::SelectRead(const Socket* pSocket, int timeoutInMs)
@@ -48,9 +61,14 @@ namespace Infra
         time.tv_sec  = static_cast<long>(timeoutInMs / 1000);
         time.tv_usec = timeoutInMs % 1000 * 1000;
 
-        if (::select(static_cast<int>(Device::ToNativeHandle(handle) + 1), &selector, nullptr, nullptr, &time) > 0)
+        const int result = ::select(static_cast<int>(Device::ToNativeHandle(handle) + 1), &selector, nullptr, nullptr, &time);
+        if (result > 0)
             return SocketState::Success;
 
+        // Timeout
+        if (result == 0)
+            return SocketState::Busy;
+
         return Device::GetErrorState();
     }
 
@@ -72,9 +90,14 @@ namespace Infra
         time.tv_sec  = static_cast<long>(timeoutInMs / 1000);
         time.tv_usec = timeoutInMs % 1000 * 1000;
 
-        if (::select(static_cast<int>(Device::ToNativeHandle(handle) + 1), nullptr, &selector, nullptr, &time) > 0)
+        const int result = ::select(static_cast<int>(Device::ToNativeHandle(handle) + 1), nullptr, &selector, nullptr, &time);
+        if (result > 0)
             return SocketState::Success;
 
+        // Timeout
+        if (result == 0)
+            return SocketState::Busy;
+
         return Device::GetErrorState();
     }
 
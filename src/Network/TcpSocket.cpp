@@ -1,3 +1,4 @@
+#include <cstring>
 #include "Infra/Network/TcpSocket.h"
 #include "Infra/Utility/ScopeGuard.h"
 #include "Windows/WindowsSocket.h"
@@ -20,10 +21,24 @@ namespace Infra
         if (::connect(Device::ToNativeHandle(pSocket->GetNativeHandle()), pSockAddr, structLen) >= 0)
             return SocketState::Success;
 
-        return Socket::SelectWrite(pSocket, timeOutInMs);
+        const SocketState connectState = Device::GetErrorState();
+        if (connectState != SocketState::Busy)
+            return connectState;
+
+        const SocketState selectState = Socket::SelectWrite(pSocket, timeOutInMs);
+        if (selectState != SocketState::Success)
+            return selectState;
+
+        // Writable also means the connection failed, the result is in SO_ERROR.
+        int error = 0;
+        SocketLength errorLen = sizeof(error);
+        if (::getsockopt(Device::ToNativeHandle(pSocket->GetNativeHandle()), SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &errorLen) != 0 || error != 0)
+            return SocketState::Error;
+
+        return SocketState::Success;
     }
 
-    std::optional<Socket> TcpSocket::Create(IpAddress::Family af)
+    std::optional<TcpSocket> TcpSocket::Create(IpAddress::Family af)
     {
         auto addressFamily = SocketUtil::GetAddressFamily(af);
         auto [wsaSocketType, wsaProtocol] = SocketUtil::GetTcpProtocol();
@@ -44,9 +59,6 @@ namespace Infra
         if (endpoint.GetAddressFamily() != _addressFamily)
             return SocketState::Error;
 
-        // Disconnect last.
-        Disconnect();
-
         union SockAddr
         {
             sockaddr_in v4;
@@ -104,7 +116,7 @@ namespace Infra
         if (_addressFamily == IpAddress::Family::IpV4)
         {
             sockaddr_in address{};
-            int structLen = sizeof(sockaddr_in);
+            SocketLength structLen = sizeof(sockaddr_in);
             if (::getpeername(Device::ToNativeHandle(_handle), reinterpret_cast<sockaddr*>(&address), &structLen) != -1)
                 return EndPoint(IpAddress(ntohl(address.sin_addr.s_addr)), ntohs(address.sin_port));
 
@@ -114,7 +126,7 @@ namespace Infra
         if (_addressFamily == IpAddress::Family::IpV6)
         {
             sockaddr_in6 address{};
-            int structLen = sizeof(sockaddr_in6);
+            SocketLength structLen = sizeof(sockaddr_in6);
             if (::getpeername(Device::ToNativeHandle(_handle), reinterpret_cast<sockaddr*>(&address), &structLen) != -1)
                 return EndPoint(IpAddress(address.sin6_addr.s6_addr), ntohs(address.sin6_port));
 
@@ -124,16 +136,23 @@ namespace Infra
         return std::nullopt;
     }
 
-    std::pair<SocketState, size_t> TcpSocket::Send(void* pData, size_t size)
+    std::pair<SocketState, size_t> TcpSocket::Send(const void* pData, size_t size)
     {
         if (pData == nullptr || size == 0)
             return { SocketState::Error, 0 };
 
-        int result = ::send(Device::ToNativeHandle(_handle), static_cast<const char*>(pData), size, 0);
+#ifdef MSG_NOSIGNAL
+        // Report a closed peer as Disconnect instead of raising SIGPIPE.
+        constexpr int flags = MSG_NOSIGNAL;
+#else
+        constexpr int flags = 0;
+#endif
+
+        const auto result = ::send(Device::ToNativeHandle(_handle), static_cast<const char*>(pData), static_cast<int>(size), flags);
         if (result < 0)
             return { Device::GetErrorState(), 0 };
 
-        return { SocketState::Success, result };
+        return { SocketState::Success, static_cast<size_t>(result) };
     }
 
     std::pair<SocketState, size_t> TcpSocket::Receive(void* pBuffer, size_t size)
@@ -141,14 +160,14 @@ namespace Infra
         if (pBuffer == nullptr || size == 0)
             return { SocketState::Error, 0 };
 
-        int result = ::recv(Device::ToNativeHandle(_handle), static_cast<char*>(pBuffer), size, 0);
+        const auto result = ::recv(Device::ToNativeHandle(_handle), static_cast<char*>(pBuffer), static_cast<int>(size), 0);
         if (result == 0)
             return { SocketState::Disconnect, 0 };
 
         if (result < 0)
             return { Device::GetErrorState(), 0 };
 
-        return { SocketState::Success, result };
+        return { SocketState::Success, static_cast<size_t>(result) };
     }
 
     TcpSocket::TcpSocket(IpAddress::Family af, void* handle)
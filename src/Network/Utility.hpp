@@ -23,12 +23,12 @@ namespace Infra
 
         static std::pair<int, int> GetTcpProtocol()
         {
-            return std::make_pair(IPPROTO_TCP, SOCK_STREAM);
+            return std::make_pair(SOCK_STREAM, IPPROTO_TCP);
         }
 
         static std::pair<int, int> GetUdpProtocol()
         {
-            return std::make_pair(IPPROTO_UDP, SOCK_DGRAM);
+            return std::make_pair(SOCK_DGRAM, IPPROTO_UDP);
         }
     };
 }
\ No newline at end of file
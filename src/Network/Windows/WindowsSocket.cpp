@@ -22,16 +22,6 @@ namespace Infra::Device
 
     WinSocketGuard gWinSocketGuard;
 
-    SocketHandle ToNativeHandle(void* handle)
-    {
-        return reinterpret_cast<SocketHandle>(handle);
-    }
-
-    void* ToGeneralHandle(SocketHandle sock)
-    {
-        return reinterpret_cast<void*>(sock);
-    }
-
     SocketHandle GetInvalidSocket()
     {
         return INVALID_SOCKET;
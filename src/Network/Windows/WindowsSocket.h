@@ -12,14 +12,21 @@
 namespace Infra
 {
     using SocketHandle = SOCKET;
+    using SocketLength = int;
 
     namespace Device
     {
         INFRA_FORCE_INLINE
-        SocketHandle ToNativeHandle(void* handle);
+        SocketHandle ToNativeHandle(void* handle)
+        {
+            return reinterpret_cast<SocketHandle>(handle);
+        }
 
         INFRA_FORCE_INLINE
-        void* ToGeneralHandle(SocketHandle sock);
+        void* ToGeneralHandle(SocketHandle sock)
+        {
+            return reinterpret_cast<void*>(sock);
+        }
 
         SocketHandle GetInvalidSocket();
 
@@ -0,0 +1,155 @@
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include "Infra/Utility/String.h"
+#include "Infra/Utility/StringReplacer.h"
+#include "String/StringSimd.hpp"
+
+namespace Infra
+{
+    using FindByteFunc = const char* (*)(const char*, const char*, char);
+    using CountByteFunc = size_t (*)(const char*, const char*, char);
+
+    static size_t CountByteScalar(const char* begin, const char* end, char target)
+    {
+        size_t count = 0;
+        for (const char* p = begin; p != end; p++)
+            count += *p == target;
+
+        return count;
+    }
+
+#if INFRA_STRING_SIMD_X64
+    static const char* FindByteSse2(const char* begin, const char* end, char target)
+    {
+        const __m128i needle = _mm_set1_epi8(target);
+
+        const char* p = begin;
+        for (; end - p >= 16; p += 16)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+            if (mask != 0)
+                return p + std::countr_zero(mask);
+        }
+
+        for (; p != end; p++)
+        {
+            if (*p == target)
+                return p;
+        }
+
+        return end;
+    }
+
+    static size_t CountByteSse2(const char* begin, const char* end, char target)
+    {
+        const __m128i needle = _mm_set1_epi8(target);
+
+        size_t count = 0;
+        const char* p = begin;
+        for (; end - p >= 16; p += 16)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            count += std::popcount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle))));
+        }
+
+        return count + CountByteScalar(p, end, target);
+    }
+
+    INFRA_TARGET_AVX2
+    static const char* FindByteAvx2(const char* begin, const char* end, char target)
+    {
+        const __m256i needle = _mm256_set1_epi8(target);
+
+        // Two blocks per round, long gaps between delimiters are scanned at one branch per 64 bytes.
+        const char* p = begin;
+        for (; end - p >= 64; p += 64)
+        {
+            const __m256i low = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), needle);
+            const __m256i high = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32)), needle);
+            if (_mm256_testz_si256(_mm256_or_si256(low, high), _mm256_or_si256(low, high)) != 0)
+                continue;
+
+            const auto lowMask = static_cast<uint32_t>(_mm256_movemask_epi8(low));
+            if (lowMask != 0)
+                return p + std::countr_zero(lowMask);
+
+            return p + 32 + std::countr_zero(static_cast<uint32_t>(_mm256_movemask_epi8(high)));
+        }
+
+        for (; end - p >= 32; p += 32)
+        {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+            if (mask != 0)
+                return p + std::countr_zero(mask);
+        }
+
+        return FindByteSse2(p, end, target);
+    }
+
+    INFRA_TARGET_AVX2
+    static size_t CountByteAvx2(const char* begin, const char* end, char target)
+    {
+        const __m256i needle = _mm256_set1_epi8(target);
+
+        size_t count = 0;
+        const char* p = begin;
+        for (; end - p >= 32; p += 32)
+        {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            count += static_cast<size_t>(_mm_popcnt_u32(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)))));
+        }
+
+        return count + CountByteSse2(p, end, target);
+    }
+
+    static FindByteFunc SelectFindByte()
+    {
+        return StringSimd::HasAvx2() ? FindByteAvx2 : FindByteSse2;
+    }
+
+    static CountByteFunc SelectCountByte()
+    {
+        return StringSimd::HasAvx2() ? CountByteAvx2 : CountByteSse2;
+    }
+#else
+    // libc memchr is usually vectorized for the target already.
+    static const char* FindByteScalar(const char* begin, const char* end, char target)
+    {
+        if (begin == end)
+            return end;
+
+        const void* pFound = std::memchr(begin, target, static_cast<size_t>(end - begin));
+        return pFound == nullptr ? end : static_cast<const char*>(pFound);
+    }
+
+    static FindByteFunc SelectFindByte()
+    {
+        return FindByteScalar;
+    }
+
+    static CountByteFunc SelectCountByte()
+    {
+        return CountByteScalar;
+    }
+#endif
+
+    const char* String::FindByte(const char* begin, const char* end, char target)
+    {
+        static const FindByteFunc pFunc = SelectFindByte();
+        return pFunc(begin, end, target);
+    }
+
+    size_t String::CountByte(const char* begin, const char* end, char target)
+    {
+        static const CountByteFunc pFunc = SelectCountByte();
+        return pFunc(begin, end, target);
+    }
+
+    std::string String::ReplaceAll(std::string_view inStr, const std::vector<std::pair<std::string, std::string>>& pairs)
+    {
+        return StringReplacer(pairs).Replace(inStr);
+    }
+}
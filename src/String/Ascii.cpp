@@ -0,0 +1,137 @@
+#include <cstring>
+#include <cstdint>
+#include "Infra/Utility/String.h"
+#include "StringSimd.hpp"
+
+namespace Infra
+{
+    /* Ascii case helpers working on 8 byte words: a byte is an upper case letter when its low
+     * seven bits are in ['A', 'Z'] and its high bit is clear, which is found for all eight bytes
+     * with two additions, and setting or clearing bit 0x20 of those bytes flips the case.
+     * Bytes of 0x80 and above, so all utf-8 sequences, are never touched.
+     */
+    static constexpr uint64_t BYTE_ONES = 0x0101010101010101ull;
+    static constexpr uint64_t BYTE_HIGH_BITS = 0x8080808080808080ull;
+
+    // High bit set in every byte of word that lies in [first, last].
+    static uint64_t AsciiRangeMask(uint64_t word, char first, char last)
+    {
+        const uint64_t low7 = word & ~BYTE_HIGH_BITS;
+        const uint64_t aboveLast = low7 + BYTE_ONES * static_cast<uint64_t>(0x7F - last);
+        const uint64_t atLeastFirst = low7 + BYTE_ONES * static_cast<uint64_t>(0x80 - first);
+        return (atLeastFirst ^ aboveLast) & ~word & BYTE_HIGH_BITS;
+    }
+
+    static uint64_t LowerWord(uint64_t word)
+    {
+        return word | (AsciiRangeMask(word, 'A', 'Z') >> 2);
+    }
+
+    static uint64_t UpperWord(uint64_t word)
+    {
+        return word & ~(AsciiRangeMask(word, 'a', 'z') >> 2);
+    }
+
+    static uint64_t LoadWord(const char* p)
+    {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        return word;
+    }
+
+    // Up to 7 bytes, the rest of the word is zero.
+    static uint64_t LoadPartialWord(const char* p, size_t size)
+    {
+        uint64_t word = 0;
+        std::memcpy(&word, p, size);
+        return word;
+    }
+
+    template <bool TO_LOWER>
+    static void ConvertCase(char* p, size_t size)
+    {
+        const char first = TO_LOWER ? 'A' : 'a';
+        const char* pEnd = p + size;
+
+#if INFRA_STRING_SIMD_X64
+        // Shift the letter range to the bottom of the signed range, one compare tests both ends.
+        const __m128i shift = _mm_set1_epi8(static_cast<char>(0x80 - first));
+        const __m128i limit = _mm_set1_epi8(static_cast<char>(0x80 + 26));
+        const __m128i caseBit = _mm_set1_epi8(0x20);
+        for (; pEnd - p >= 16; p += 16)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i letters = _mm_cmplt_epi8(_mm_add_epi8(block, shift), limit);
+            const __m128i flip = _mm_and_si128(letters, caseBit);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p), TO_LOWER ? _mm_or_si128(block, flip) : _mm_andnot_si128(flip, block));
+        }
+#endif
+
+        for (; pEnd - p >= 8; p += 8)
+        {
+            const uint64_t word = TO_LOWER ? LowerWord(LoadWord(p)) : UpperWord(LoadWord(p));
+            std::memcpy(p, &word, sizeof(word));
+        }
+
+        for (; p != pEnd; p++)
+        {
+            if (*p >= first && *p < first + 26)
+                *p = static_cast<char>(*p ^ 0x20);
+        }
+    }
+
+    void String::ToLower(std::string& str)
+    {
+        ConvertCase<true>(str.data(), str.size());
+    }
+
+    void String::ToUpper(std::string& str)
+    {
+        ConvertCase<false>(str.data(), str.size());
+    }
+
+    bool String::EqualsIgnoreCase(std::string_view lhs, std::string_view rhs)
+    {
+        if (lhs.size() != rhs.size())
+            return false;
+
+        const char* pLhs = lhs.data();
+        const char* pRhs = rhs.data();
+        size_t remain = lhs.size();
+        for (; remain >= 8; remain -= 8, pLhs += 8, pRhs += 8)
+        {
+            // Equal words need no case folding, which is the common case for normalized keys.
+            const uint64_t lhsWord = LoadWord(pLhs);
+            const uint64_t rhsWord = LoadWord(pRhs);
+            if (lhsWord != rhsWord && LowerWord(lhsWord) != LowerWord(rhsWord))
+                return false;
+        }
+
+        return LowerWord(LoadPartialWord(pLhs, remain)) == LowerWord(LoadPartialWord(pRhs, remain));
+    }
+
+    size_t String::HashIgnoreCase(std::string_view str)
+    {
+        // Multiply and fold per lowered word, seeded with the size so zero padding of the tail
+        // cannot make strings of different sizes collide.
+        constexpr uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ull;
+
+        uint64_t hash = static_cast<uint64_t>(str.size()) * MULTIPLIER;
+        const char* p = str.data();
+        size_t remain = str.size();
+        for (; remain >= 8; remain -= 8, p += 8)
+        {
+            hash = (hash ^ LowerWord(LoadWord(p))) * MULTIPLIER;
+            hash ^= hash >> 32;
+        }
+
+        if (remain != 0)
+        {
+            hash = (hash ^ LowerWord(LoadPartialWord(p, remain))) * MULTIPLIER;
+            hash ^= hash >> 32;
+        }
+
+        hash = (hash ^ (hash >> 29)) * MULTIPLIER;
+        return static_cast<size_t>(hash ^ (hash >> 32));
+    }
+}
@@ -0,0 +1,242 @@
+#include <bit>
+#include <cstring>
+#include <cstdint>
+#include "Infra/Utility/String.h"
+#include "StringSimd.hpp"
+
+namespace Infra
+{
+    /* Substring search with the first and last byte filter: a block of candidate positions is
+     * kept only where both the first needle byte and the last needle byte, needle size - 1
+     * further, match, and only those candidates are compared in full. Two bytes far apart
+     * rarely match together, so long needles are verified about as seldom as short ones.
+     */
+    using FindFunc = size_t (*)(std::string_view, std::string_view, size_t);
+    using FindAnyFunc = size_t (*)(std::string_view, std::span<const std::string_view>, size_t*);
+
+    static bool MatchAt(const char* p, std::string_view needle)
+    {
+        return std::memcmp(p, needle.data(), needle.size()) == 0;
+    }
+
+    // Leftmost longest match starting at position p, the index of the needle or SIZE_MAX.
+    static size_t MatchAnyAt(std::string_view haystack, size_t p, std::span<const std::string_view> needles)
+    {
+        size_t found = SIZE_MAX;
+        for (size_t i = 0; i < needles.size(); i++)
+        {
+            const std::string_view needle = needles[i];
+            if (needle.empty() || needle.size() > haystack.size() - p)
+                continue;
+
+            if (needle[0] != haystack[p] || (found != SIZE_MAX && needle.size() <= needles[found].size()))
+                continue;
+
+            if (MatchAt(haystack.data() + p, needle))
+                found = i;
+        }
+
+        return found;
+    }
+
+    static size_t FindScalar(std::string_view haystack, std::string_view needle, size_t pos)
+    {
+        return haystack.find(needle, pos);
+    }
+
+    static size_t FindAnyScalar(std::string_view haystack, std::span<const std::string_view> needles, size_t* pNeedleIndex)
+    {
+        for (size_t p = 0; p < haystack.size(); p++)
+        {
+            const size_t index = MatchAnyAt(haystack, p, needles);
+            if (index != SIZE_MAX)
+            {
+                if (pNeedleIndex != nullptr)
+                    *pNeedleIndex = index;
+
+                return p;
+            }
+        }
+
+        return std::string_view::npos;
+    }
+
+#if INFRA_STRING_SIMD_X64
+    static size_t FindSse2(std::string_view haystack, std::string_view needle, size_t pos)
+    {
+        const size_t lastOffset = needle.size() - 1;
+        const __m128i first = _mm_set1_epi8(needle.front());
+        const __m128i last = _mm_set1_epi8(needle.back());
+        const char* pHaystack = haystack.data();
+
+        // Both loads of a block stay inside the haystack.
+        size_t p = pos;
+        for (; p + lastOffset + 16 <= haystack.size(); p += 16)
+        {
+            const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pHaystack + p));
+            const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pHaystack + p + lastOffset));
+            auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last))));
+            while (mask != 0)
+            {
+                const size_t candidate = p + static_cast<size_t>(std::countr_zero(mask));
+                if (MatchAt(pHaystack + candidate, needle))
+                    return candidate;
+
+                mask &= mask - 1;
+            }
+        }
+
+        return FindScalar(haystack, needle, p);
+    }
+
+    INFRA_TARGET_AVX2
+    static size_t FindAvx2(std::string_view haystack, std::string_view needle, size_t pos)
+    {
+        const size_t lastOffset = needle.size() - 1;
+        const __m256i first = _mm256_set1_epi8(needle.front());
+        const __m256i last = _mm256_set1_epi8(needle.back());
+        const char* pHaystack = haystack.data();
+
+        size_t p = pos;
+        for (; p + lastOffset + 32 <= haystack.size(); p += 32)
+        {
+            const __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pHaystack + p));
+            const __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pHaystack + p + lastOffset));
+            auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last))));
+            while (mask != 0)
+            {
+                const size_t candidate = p + static_cast<size_t>(std::countr_zero(mask));
+                if (MatchAt(pHaystack + candidate, needle))
+                    return candidate;
+
+                mask &= mask - 1;
+            }
+        }
+
+        return FindSse2(haystack, needle, p);
+    }
+
+    // Every needle filters the block on its own, candidates of all needles are visited in order.
+    INFRA_TARGET_AVX2
+    static size_t FindAnyAvx2(std::string_view haystack, std::span<const std::string_view> needles, size_t* pNeedleIndex)
+    {
+        size_t longest = 0;
+        for (const auto& needle : needles)
+            longest = std::max(longest, needle.size());
+
+        const char* pHaystack = haystack.data();
+        size_t p = 0;
+        for (; p + longest + 32 <= haystack.size(); p += 32)
+        {
+            const __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pHaystack + p));
+
+            uint32_t mask = 0;
+            for (const auto& needle : needles)
+            {
+                if (needle.empty())
+                    continue;
+
+                const __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pHaystack + p + needle.size() - 1));
+                const __m256i matchFirst = _mm256_cmpeq_epi8(blockFirst, _mm256_set1_epi8(needle.front()));
+                const __m256i matchLast = _mm256_cmpeq_epi8(blockLast, _mm256_set1_epi8(needle.back()));
+                mask |= static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(matchFirst, matchLast)));
+            }
+
+            while (mask != 0)
+            {
+                const size_t candidate = p + static_cast<size_t>(std::countr_zero(mask));
+                const size_t index = MatchAnyAt(haystack, candidate, needles);
+                if (index != SIZE_MAX)
+                {
+                    if (pNeedleIndex != nullptr)
+                        *pNeedleIndex = index;
+
+                    return candidate;
+                }
+
+                mask &= mask - 1;
+            }
+        }
+
+        const size_t found = FindAnyScalar(haystack.substr(p), needles, pNeedleIndex);
+        return found == std::string_view::npos ? found : p + found;
+    }
+
+    static FindFunc SelectFind()
+    {
+        return StringSimd::HasAvx2() ? FindAvx2 : FindSse2;
+    }
+
+    static FindAnyFunc SelectFindAny()
+    {
+        return StringSimd::HasAvx2() ? FindAnyAvx2 : FindAnyScalar;
+    }
+#else
+    static FindFunc SelectFind()
+    {
+        return FindScalar;
+    }
+
+    static FindAnyFunc SelectFindAny()
+    {
+        return FindAnyScalar;
+    }
+#endif
+
+    size_t String::Find(std::string_view haystack, std::string_view needle, size_t pos)
+    {
+        if (pos > haystack.size() || needle.size() > haystack.size() - pos)
+            return std::string_view::npos;
+
+        if (needle.empty())
+            return pos;
+
+        if (needle.size() == 1)
+        {
+            const char* pEnd = haystack.data() + haystack.size();
+            const char* pFound = FindByte(haystack.data() + pos, pEnd, needle[0]);
+            return pFound == pEnd ? std::string_view::npos : static_cast<size_t>(pFound - haystack.data());
+        }
+
+        static const FindFunc pFunc = SelectFind();
+        return pFunc(haystack, needle, pos);
+    }
+
+    bool String::Contains(std::string_view haystack, std::string_view needle)
+    {
+        return Find(haystack, needle) != std::string_view::npos;
+    }
+
+    size_t String::Count(std::string_view haystack, std::string_view needle)
+    {
+        if (needle.empty())
+            return 0;
+
+        if (needle.size() == 1)
+            return CountByte(haystack.data(), haystack.data() + haystack.size(), needle[0]);
+
+        size_t count = 0;
+        for (size_t pos = Find(haystack, needle); pos != std::string_view::npos; pos = Find(haystack, needle, pos + needle.size()))
+            count++;
+
+        return count;
+    }
+
+    std::vector<size_t> String::FindAll(std::string_view haystack, std::string_view needle)
+    {
+        std::vector<size_t> result;
+        if (needle.empty())
+            return result;
+
+        for (size_t pos = Find(haystack, needle); pos != std::string_view::npos; pos = Find(haystack, needle, pos + needle.size()))
+            result.push_back(pos);
+
+        return result;
+    }
+
+    size_t String::FindAny(std::string_view haystack, std::span<const std::string_view> needles, size_t* pNeedleIndex)
+    {
+        static const FindAnyFunc pFunc = SelectFindAny();
+        return pFunc(haystack, needles, pNeedleIndex);
+    }
+}
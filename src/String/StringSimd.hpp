@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Infra/PlatformDefine.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#   define INFRA_STRING_SIMD_X64 1
+#   include <immintrin.h>
+#   if COMPILER_MSVC
+#       include <intrin.h>
+#       define INFRA_TARGET_AVX2
+#   else
+#       define INFRA_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#   endif
+#else
+#   define INFRA_STRING_SIMD_X64 0
+#endif
+
+namespace Infra
+{
+    /* Cpu feature checks shared by the string kernels. SSE2 is part of x86-64 and used
+     * unconditionally there, AVX2 kernels are selected at runtime.
+     */
+    class StringSimd
+    {
+    public:
+        StringSimd() = delete;
+
+    public:
+        static bool HasAvx2()
+        {
+#if INFRA_STRING_SIMD_X64
+            static const bool hasAvx2 = CheckAvx2();
+            return hasAvx2;
+#else
+            return false;
+#endif
+        }
+
+    private:
+#if INFRA_STRING_SIMD_X64
+        static bool CheckAvx2()
+        {
+#   if COMPILER_MSVC
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7)
+                return false;
+
+            // Cpu support and os saving ymm registers are both required.
+            __cpuid(info, 1);
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            const bool popcnt = (info[2] & (1 << 23)) != 0;
+            if (!osxsave || !popcnt || (_xgetbv(0) & 0x6) != 0x6)
+                return false;
+
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+#   else
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#   endif
+        }
+#endif
+    };
+}
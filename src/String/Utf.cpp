@@ -0,0 +1,595 @@
+#include <cstdint>
+#include <cstring>
+#include <bit>
+#include "Infra/Utility/String.h"
+#include "StringSimd.hpp"
+
+namespace Infra
+{
+    /* Transcoding between utf-8, utf-16 and utf-32, the encoding is picked by code unit size,
+     * so wchar_t is utf-16 on Windows and utf-32 elsewhere. No locale is involved.
+     * Output is sized for the worst case once and shrunk at the end, runs of ascii are
+     * widened or narrowed 16 units at a time with SSE2 on x86-64.
+     */
+    static constexpr char32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+    template <typename Char>
+    using CodeUnit = std::conditional_t<sizeof(Char) == 1, uint8_t, std::conditional_t<sizeof(Char) == 2, uint16_t, uint32_t>>;
+
+    // Most output code units one input code unit can produce.
+    template <typename InChar, typename OutChar>
+    static constexpr size_t MaxExpansion()
+    {
+        if constexpr (sizeof(OutChar) == 1)
+            return sizeof(InChar) == 2 ? 3 : 4;
+        else if constexpr (sizeof(OutChar) == 2 && sizeof(InChar) == 4)
+            return 2;
+        else
+            return 1;
+    }
+
+    template <typename InChar>
+    static bool Decode(const InChar*& pIn, const InChar* pEnd, char32_t& codePoint)
+    {
+        const auto unit = static_cast<CodeUnit<InChar>>(*pIn);
+
+        if constexpr (sizeof(InChar) == 1)
+        {
+            const auto IsContinuation = [](InChar ch) -> bool
+            {
+                return (static_cast<uint8_t>(ch) & 0xC0) == 0x80;
+            };
+
+            const size_t available = static_cast<size_t>(pEnd - pIn);
+
+            // C0 and C1 could only start overlong forms, F5 and above only values past unicode.
+            if (unit < 0xC2)
+            {
+                if (unit >= 0x80)
+                    return false;
+
+                codePoint = unit;
+                pIn++;
+                return true;
+            }
+
+            if (unit < 0xE0)
+            {
+                if (available < 2 || !IsContinuation(pIn[1]))
+                    return false;
+
+                codePoint = (static_cast<char32_t>(unit & 0x1F) << 6) | (static_cast<uint8_t>(pIn[1]) & 0x3F);
+                pIn += 2;
+                return true;
+            }
+
+            if (unit < 0xF0)
+            {
+                if (available < 3 || !IsContinuation(pIn[1]) || !IsContinuation(pIn[2]))
+                    return false;
+
+                codePoint = (static_cast<char32_t>(unit & 0x0F) << 12) | (static_cast<char32_t>(static_cast<uint8_t>(pIn[1]) & 0x3F) << 6)
+                    | (static_cast<uint8_t>(pIn[2]) & 0x3F);
+
+                // Overlong forms and surrogates.
+                if (codePoint < 0x800 || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+                    return false;
+
+                pIn += 3;
+                return true;
+            }
+
+            if (unit < 0xF5)
+            {
+                if (available < 4 || !IsContinuation(pIn[1]) || !IsContinuation(pIn[2]) || !IsContinuation(pIn[3]))
+                    return false;
+
+                codePoint = (static_cast<char32_t>(unit & 0x07) << 18) | (static_cast<char32_t>(static_cast<uint8_t>(pIn[1]) & 0x3F) << 12)
+                    | (static_cast<char32_t>(static_cast<uint8_t>(pIn[2]) & 0x3F) << 6) | (static_cast<uint8_t>(pIn[3]) & 0x3F);
+
+                // Overlong forms and values past U+10FFFF.
+                if (codePoint < 0x10000 || codePoint > 0x10FFFF)
+                    return false;
+
+                pIn += 4;
+                return true;
+            }
+
+            return false;
+        }
+        else if constexpr (sizeof(InChar) == 2)
+        {
+            if (unit < 0xD800 || unit > 0xDFFF)
+            {
+                codePoint = unit;
+                pIn++;
+                return true;
+            }
+
+            if (unit > 0xDBFF || pEnd - pIn < 2)
+                return false;
+
+            const auto low = static_cast<uint16_t>(pIn[1]);
+            if (low < 0xDC00 || low > 0xDFFF)
+                return false;
+
+            codePoint = 0x10000 + ((static_cast<char32_t>(unit) - 0xD800) << 10) + (low - 0xDC00);
+            pIn += 2;
+            return true;
+        }
+        else
+        {
+            if (unit > 0x10FFFF || (unit >= 0xD800 && unit <= 0xDFFF))
+                return false;
+
+            codePoint = unit;
+            pIn++;
+            return true;
+        }
+    }
+
+    template <typename OutChar>
+    static OutChar* Encode(char32_t codePoint, OutChar* pOut)
+    {
+        if constexpr (sizeof(OutChar) == 1)
+        {
+            if (codePoint < 0x80)
+                *pOut++ = static_cast<OutChar>(codePoint);
+            else if (codePoint < 0x800)
+            {
+                *pOut++ = static_cast<OutChar>(0xC0 | (codePoint >> 6));
+                *pOut++ = static_cast<OutChar>(0x80 | (codePoint & 0x3F));
+            }
+            else if (codePoint < 0x10000)
+            {
+                *pOut++ = static_cast<OutChar>(0xE0 | (codePoint >> 12));
+                *pOut++ = static_cast<OutChar>(0x80 | ((codePoint >> 6) & 0x3F));
+                *pOut++ = static_cast<OutChar>(0x80 | (codePoint & 0x3F));
+            }
+            else
+            {
+                *pOut++ = static_cast<OutChar>(0xF0 | (codePoint >> 18));
+                *pOut++ = static_cast<OutChar>(0x80 | ((codePoint >> 12) & 0x3F));
+                *pOut++ = static_cast<OutChar>(0x80 | ((codePoint >> 6) & 0x3F));
+                *pOut++ = static_cast<OutChar>(0x80 | (codePoint & 0x3F));
+            }
+        }
+        else if constexpr (sizeof(OutChar) == 2)
+        {
+            if (codePoint < 0x10000)
+                *pOut++ = static_cast<OutChar>(codePoint);
+            else
+            {
+                codePoint -= 0x10000;
+                *pOut++ = static_cast<OutChar>(0xD800 + (codePoint >> 10));
+                *pOut++ = static_cast<OutChar>(0xDC00 + (codePoint & 0x3FF));
+            }
+        }
+        else
+            *pOut++ = static_cast<OutChar>(codePoint);
+
+        return pOut;
+    }
+
+    // Copy the ascii run at pIn, both pointers are advanced past it.
+    template <typename InChar, typename OutChar>
+    static void CopyAscii(const InChar*& pIn, const InChar* pEnd, OutChar*& pOut)
+    {
+#if INFRA_STRING_SIMD_X64
+        if constexpr (sizeof(InChar) == 1 && sizeof(OutChar) > 1)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            while (pEnd - pIn >= 16)
+            {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn));
+                if (_mm_movemask_epi8(bytes) != 0)
+                    break;
+
+                const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+                const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+                if constexpr (sizeof(OutChar) == 2)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut), low);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + 8), high);
+                }
+                else
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut), _mm_unpacklo_epi16(low, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + 4), _mm_unpackhi_epi16(low, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + 8), _mm_unpacklo_epi16(high, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + 12), _mm_unpackhi_epi16(high, zero));
+                }
+
+                pIn += 16;
+                pOut += 16;
+            }
+        }
+        else if constexpr (sizeof(InChar) == 2 && sizeof(OutChar) == 1)
+        {
+            const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+            const __m128i zero = _mm_setzero_si128();
+            while (pEnd - pIn >= 16)
+            {
+                const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn));
+                const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + 8));
+                const __m128i highBits = _mm_and_si128(_mm_or_si128(first, second), nonAscii);
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(highBits, zero)) != 0xFFFF)
+                    break;
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut), _mm_packus_epi16(first, second));
+                pIn += 16;
+                pOut += 16;
+            }
+        }
+        else if constexpr (sizeof(InChar) == 4 && sizeof(OutChar) == 1)
+        {
+            const __m128i nonAscii = _mm_set1_epi32(static_cast<int>(0xFFFFFF80));
+            const __m128i zero = _mm_setzero_si128();
+            while (pEnd - pIn >= 16)
+            {
+                const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn));
+                const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + 4));
+                const __m128i third = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + 8));
+                const __m128i fourth = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + 12));
+                const __m128i all = _mm_or_si128(_mm_or_si128(first, second), _mm_or_si128(third, fourth));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(all, nonAscii), zero)) != 0xFFFF)
+                    break;
+
+                const __m128i low = _mm_packs_epi32(first, second);
+                const __m128i high = _mm_packs_epi32(third, fourth);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut), _mm_packus_epi16(low, high));
+                pIn += 16;
+                pOut += 16;
+            }
+        }
+#endif
+
+        while (pIn != pEnd && static_cast<CodeUnit<InChar>>(*pIn) < 0x80)
+            *pOut++ = static_cast<OutChar>(*pIn++);
+    }
+
+    // Invalid sequences either fail the whole conversion or become U+FFFD, skipping one code unit.
+    template <typename InChar, typename OutChar>
+    static bool Transcode(std::basic_string_view<InChar> input, std::basic_string<OutChar>& output, bool replaceInvalid, size_t* pErrorOffset)
+    {
+        output.resize(input.size() * MaxExpansion<InChar, OutChar>());
+
+        const InChar* pIn = input.data();
+        const InChar* pEnd = pIn + input.size();
+        OutChar* pOut = output.data();
+
+        while (pIn != pEnd)
+        {
+            if (static_cast<CodeUnit<InChar>>(*pIn) < 0x80)
+            {
+                CopyAscii(pIn, pEnd, pOut);
+                continue;
+            }
+
+            const InChar* pSequence = pIn;
+            char32_t codePoint;
+            if (!Decode(pIn, pEnd, codePoint))
+            {
+                if (!replaceInvalid)
+                {
+                    if (pErrorOffset != nullptr)
+                        *pErrorOffset = static_cast<size_t>(pSequence - input.data());
+
+                    output.clear();
+                    return false;
+                }
+
+                codePoint = REPLACEMENT_CHARACTER;
+                pIn = pSequence + 1;
+            }
+
+            pOut = Encode(codePoint, pOut);
+        }
+
+        output.resize(static_cast<size_t>(pOut - output.data()));
+        return true;
+    }
+
+    template <typename OutChar, typename InChar>
+    static std::optional<std::basic_string<OutChar>> TranscodeStrict(std::basic_string_view<InChar> input, size_t* pErrorOffset)
+    {
+        std::basic_string<OutChar> output;
+        if (!Transcode(input, output, false, pErrorOffset))
+            return std::nullopt;
+
+        return output;
+    }
+
+    std::string String::WideStringToString(const std::wstring& wStr)
+    {
+        std::string result;
+        Transcode(std::wstring_view(wStr), result, true, nullptr);
+        return result;
+    }
+
+    std::wstring String::StringToWideString(const std::string& str)
+    {
+        std::wstring result;
+        Transcode(std::string_view(str), result, true, nullptr);
+        return result;
+    }
+
+    std::optional<std::u16string> String::Utf8ToUtf16(std::string_view str, size_t* pErrorOffset)
+    {
+        return TranscodeStrict<char16_t>(str, pErrorOffset);
+    }
+
+    std::optional<std::u32string> String::Utf8ToUtf32(std::string_view str, size_t* pErrorOffset)
+    {
+        return TranscodeStrict<char32_t>(str, pErrorOffset);
+    }
+
+    std::optional<std::string> String::Utf16ToUtf8(std::u16string_view str, size_t* pErrorOffset)
+    {
+        return TranscodeStrict<char>(str, pErrorOffset);
+    }
+
+    std::optional<std::string> String::Utf32ToUtf8(std::u32string_view str, size_t* pErrorOffset)
+    {
+        return TranscodeStrict<char>(str, pErrorOffset);
+    }
+
+    using ValidateUtf8Func = size_t (*)(std::string_view);
+    using CountCodePointsFunc = size_t (*)(const char*, const char*);
+
+    // Offset of the first invalid sequence at or after pos, the size of str when the rest is valid.
+    static size_t ValidateUtf8Scalar(std::string_view str, size_t pos)
+    {
+        const char* pBegin = str.data();
+        const char* pIn = pBegin + pos;
+        const char* pEnd = pBegin + str.size();
+
+        while (pIn != pEnd)
+        {
+            // Eight ascii bytes per step.
+            while (pEnd - pIn >= 8)
+            {
+                uint64_t word;
+                std::memcpy(&word, pIn, sizeof(word));
+                if ((word & 0x8080808080808080ull) != 0)
+                    break;
+
+                pIn += 8;
+            }
+
+            if (pIn == pEnd)
+                break;
+
+            const char* pSequence = pIn;
+            char32_t codePoint;
+            if (!Decode(pIn, pEnd, codePoint))
+                return static_cast<size_t>(pSequence - pBegin);
+        }
+
+        return str.size();
+    }
+
+    // First sequence start in [pos - 3, pos], a block kernel knows everything before it is valid.
+    static size_t Utf8RestartOffset(std::string_view str, size_t pos)
+    {
+        size_t restart = pos < 3 ? 0 : pos - 3;
+        while (restart < pos && (static_cast<uint8_t>(str[restart]) & 0xC0) == 0x80)
+            restart++;
+
+        return restart;
+    }
+
+    static size_t CountCodePointsScalar(const char* begin, const char* end)
+    {
+        size_t count = 0;
+        for (const char* p = begin; p != end; p++)
+            count += (static_cast<uint8_t>(*p) & 0xC0) != 0x80;
+
+        return count;
+    }
+
+#if INFRA_STRING_SIMD_X64
+    /* Lookup validation of Keiser and Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte".
+     * Each byte is classified together with the byte before it by three 16 entry tables, indexed by
+     * the high and low nibble of the previous byte and the high nibble of the current one. A bit
+     * survives the and of the three lookups only if the pair shows that error. Whether a byte has to
+     * be the 2nd or 3rd continuation of a 3 or 4 byte sequence is checked against the bytes 2 and 3
+     * back, which is what TWO_CONTINUATIONS must agree with.
+     */
+    static constexpr uint8_t UTF8_TOO_SHORT = 1 << 0;           // 11______ 0_______ or 11______ 11______
+    static constexpr uint8_t UTF8_TOO_LONG = 1 << 1;            // 0_______ 10______
+    static constexpr uint8_t UTF8_OVERLONG_3 = 1 << 2;          // 11100000 100_____
+    static constexpr uint8_t UTF8_TOO_LARGE = 1 << 3;           // 11110100 1001____ and above
+    static constexpr uint8_t UTF8_SURROGATE = 1 << 4;           // 11101101 101_____
+    static constexpr uint8_t UTF8_OVERLONG_2 = 1 << 5;          // 1100000_ 10______
+    static constexpr uint8_t UTF8_TOO_LARGE_1000 = 1 << 6;      // 11110101 1000____ and above
+    static constexpr uint8_t UTF8_OVERLONG_4 = 1 << 6;          // 11110000 1000____
+    static constexpr uint8_t UTF8_TWO_CONTINUATIONS = 1 << 7;   // 10______ 10______
+    static constexpr uint8_t UTF8_CARRY = UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTINUATIONS;
+
+    INFRA_TARGET_AVX2
+    static __m256i Utf8Table(uint8_t e0, uint8_t e1, uint8_t e2, uint8_t e3, uint8_t e4, uint8_t e5, uint8_t e6, uint8_t e7,
+        uint8_t e8, uint8_t e9, uint8_t e10, uint8_t e11, uint8_t e12, uint8_t e13, uint8_t e14, uint8_t e15)
+    {
+        // vpshufb looks up inside each 128 bit lane, so both lanes hold the table.
+        return _mm256_setr_epi8(
+            static_cast<char>(e0), static_cast<char>(e1), static_cast<char>(e2), static_cast<char>(e3),
+            static_cast<char>(e4), static_cast<char>(e5), static_cast<char>(e6), static_cast<char>(e7),
+            static_cast<char>(e8), static_cast<char>(e9), static_cast<char>(e10), static_cast<char>(e11),
+            static_cast<char>(e12), static_cast<char>(e13), static_cast<char>(e14), static_cast<char>(e15),
+            static_cast<char>(e0), static_cast<char>(e1), static_cast<char>(e2), static_cast<char>(e3),
+            static_cast<char>(e4), static_cast<char>(e5), static_cast<char>(e6), static_cast<char>(e7),
+            static_cast<char>(e8), static_cast<char>(e9), static_cast<char>(e10), static_cast<char>(e11),
+            static_cast<char>(e12), static_cast<char>(e13), static_cast<char>(e14), static_cast<char>(e15));
+    }
+
+    // Non zero bytes where the block, read after previous, is invalid.
+    INFRA_TARGET_AVX2
+    static __m256i Utf8BlockErrors(__m256i input, __m256i previous)
+    {
+        constexpr uint8_t LONG = UTF8_TOO_LONG;
+        constexpr uint8_t CONT = UTF8_TWO_CONTINUATIONS;
+        constexpr uint8_t LARGE = UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000;
+        constexpr uint8_t SECOND = UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTINUATIONS;
+
+        const __m256i byte1HighTable = Utf8Table(LONG, LONG, LONG, LONG, LONG, LONG, LONG, LONG, CONT, CONT, CONT, CONT,
+            UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+            UTF8_TOO_SHORT,
+            UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+            UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4);
+
+        const __m256i byte1LowTable = Utf8Table(
+            UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+            UTF8_CARRY | UTF8_OVERLONG_2,
+            UTF8_CARRY,
+            UTF8_CARRY,
+            UTF8_CARRY | UTF8_TOO_LARGE,
+            LARGE, LARGE, LARGE, LARGE, LARGE, LARGE, LARGE, LARGE,
+            LARGE | UTF8_SURROGATE,
+            LARGE, LARGE);
+
+        const __m256i byte2HighTable = Utf8Table(
+            UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+            UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+            SECOND | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+            SECOND | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+            SECOND | UTF8_SURROGATE | UTF8_TOO_LARGE,
+            SECOND | UTF8_SURROGATE | UTF8_TOO_LARGE,
+            UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT);
+
+        const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+
+        // Bytes 1, 2 and 3 back, across the lane and block boundaries.
+        const __m256i carried = _mm256_permute2x128_si256(previous, input, 0x21);
+        const __m256i prev1 = _mm256_alignr_epi8(input, carried, 15);
+        const __m256i prev2 = _mm256_alignr_epi8(input, carried, 14);
+        const __m256i prev3 = _mm256_alignr_epi8(input, carried, 13);
+
+        const __m256i byte1High = _mm256_shuffle_epi8(byte1HighTable, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibbleMask));
+        const __m256i byte1Low = _mm256_shuffle_epi8(byte1LowTable, _mm256_and_si256(prev1, nibbleMask));
+        const __m256i byte2High = _mm256_shuffle_epi8(byte2HighTable, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibbleMask));
+        const __m256i special = _mm256_and_si256(_mm256_and_si256(byte1High, byte1Low), byte2High);
+
+        // Only 111_____ two back or 1111____ three back keep the high bit after the saturating subtraction.
+        const __m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+        const __m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+        const __m256i mustContinue = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+
+        return _mm256_xor_si256(mustContinue, special);
+    }
+
+    // Blocks are checked 32 bytes at a time, the first failing block and the tail are handed to the
+    // scalar decoder, which also finds the exact offset.
+    INFRA_TARGET_AVX2
+    static size_t ValidateUtf8Avx2(std::string_view str)
+    {
+        // A block ending in a lead byte whose sequence cannot fit keeps a non zero byte here.
+        const __m256i incompleteLimit = _mm256_setr_epi8(
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+
+        const size_t blockEnd = str.size() & ~static_cast<size_t>(31);
+        __m256i previous = _mm256_setzero_si256();
+        __m256i previousIncomplete = _mm256_setzero_si256();
+
+        size_t pos = 0;
+        for (; pos < blockEnd; pos += 32)
+        {
+            const __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str.data() + pos));
+
+            // An ascii block is valid unless the block before left a sequence open.
+            const __m256i errors = _mm256_movemask_epi8(input) == 0 ? previousIncomplete : Utf8BlockErrors(input, previous);
+            if (_mm256_testz_si256(errors, errors) == 0)
+                break;
+
+            previousIncomplete = _mm256_subs_epu8(input, incompleteLimit);
+            previous = input;
+        }
+
+        return ValidateUtf8Scalar(str, Utf8RestartOffset(str, pos));
+    }
+
+    static size_t ValidateUtf8Fallback(std::string_view str)
+    {
+        return ValidateUtf8Scalar(str, 0);
+    }
+
+    // Continuation bytes 0x80 - 0xBF are the only bytes not greater than -65 as signed.
+    static size_t CountCodePointsSse2(const char* begin, const char* end)
+    {
+        const __m128i threshold = _mm_set1_epi8(-65);
+
+        size_t count = 0;
+        const char* p = begin;
+        for (; end - p >= 16; p += 16)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            count += std::popcount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(block, threshold))));
+        }
+
+        return count + CountCodePointsScalar(p, end);
+    }
+
+    INFRA_TARGET_AVX2
+    static size_t CountCodePointsAvx2(const char* begin, const char* end)
+    {
+        const __m256i threshold = _mm256_set1_epi8(-65);
+
+        size_t count = 0;
+        const char* p = begin;
+        for (; end - p >= 32; p += 32)
+        {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            count += static_cast<size_t>(_mm_popcnt_u32(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(block, threshold)))));
+        }
+
+        return count + CountCodePointsSse2(p, end);
+    }
+
+    static ValidateUtf8Func SelectValidateUtf8()
+    {
+        return StringSimd::HasAvx2() ? ValidateUtf8Avx2 : ValidateUtf8Fallback;
+    }
+
+    static CountCodePointsFunc SelectCountCodePoints()
+    {
+        return StringSimd::HasAvx2() ? CountCodePointsAvx2 : CountCodePointsSse2;
+    }
+#else
+    static size_t ValidateUtf8Fallback(std::string_view str)
+    {
+        return ValidateUtf8Scalar(str, 0);
+    }
+
+    static ValidateUtf8Func SelectValidateUtf8()
+    {
+        return ValidateUtf8Fallback;
+    }
+
+    static CountCodePointsFunc SelectCountCodePoints()
+    {
+        return CountCodePointsScalar;
+    }
+#endif
+
+    bool String::ValidateUtf8(std::string_view str, size_t* pErrorOffset)
+    {
+        static const ValidateUtf8Func pFunc = SelectValidateUtf8();
+
+        const size_t errorOffset = pFunc(str);
+        if (errorOffset == str.size())
+            return true;
+
+        if (pErrorOffset != nullptr)
+            *pErrorOffset = errorOffset;
+
+        return false;
+    }
+
+    size_t String::CountCodePoints(std::string_view str)
+    {
+        static const CountCodePointsFunc pFunc = SelectCountCodePoints();
+        return pFunc(str.data(), str.data() + str.size());
+    }
+}
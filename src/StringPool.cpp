@@ -0,0 +1,134 @@
+#include <mutex>
+#include <cstring>
+#include "Infra/Utility/StringPool.h"
+
+namespace Infra
+{
+    StringPool::StringPool()
+        : StringPool(Config())
+    {
+    }
+
+    StringPool::StringPool(const Config& config)
+        : _config(config)
+        , _pBlockCurrent(nullptr)
+        , _blockRemain(0)
+        , _arenaSize(0)
+    {
+    }
+
+    StringPool::Id StringPool::Intern(std::string_view str)
+    {
+        if (!_config.threadSafe)
+            return InternLocked(str);
+
+        {
+            std::shared_lock<std::shared_mutex> guard(_mutex);
+            const auto itr = _idMap.find(str);
+            if (itr != _idMap.end())
+                return itr->second;
+        }
+
+        std::unique_lock<std::shared_mutex> guard(_mutex);
+        return InternLocked(str);
+    }
+
+    std::optional<StringPool::Id> StringPool::Find(std::string_view str) const
+    {
+        std::shared_lock<std::shared_mutex> guard(_mutex, std::defer_lock);
+        if (_config.threadSafe)
+            guard.lock();
+
+        const auto itr = _idMap.find(str);
+        if (itr == _idMap.end())
+            return std::nullopt;
+
+        return itr->second;
+    }
+
+    std::string_view StringPool::GetView(Id id) const
+    {
+        std::shared_lock<std::shared_mutex> guard(_mutex, std::defer_lock);
+        if (_config.threadSafe)
+            guard.lock();
+
+        return _views[id];
+    }
+
+    size_t StringPool::Size() const
+    {
+        std::shared_lock<std::shared_mutex> guard(_mutex, std::defer_lock);
+        if (_config.threadSafe)
+            guard.lock();
+
+        return _views.size();
+    }
+
+    size_t StringPool::GetArenaSize() const
+    {
+        std::shared_lock<std::shared_mutex> guard(_mutex, std::defer_lock);
+        if (_config.threadSafe)
+            guard.lock();
+
+        return _arenaSize;
+    }
+
+    StringPool::Id StringPool::InternLocked(std::string_view str)
+    {
+        const auto itr = _idMap.find(str);
+        if (itr != _idMap.end())
+            return itr->second;
+
+        const std::string_view stored = CopyToArena(str);
+        const auto id = static_cast<Id>(_views.size());
+        _views.push_back(stored);
+        _idMap.emplace(stored, id);
+        return id;
+    }
+
+    void StringPool::InternViews(const std::string_view* pViews, size_t count, Id* pIds)
+    {
+        std::unique_lock<std::shared_mutex> guard(_mutex, std::defer_lock);
+        if (_config.threadSafe)
+            guard.lock();
+
+        // Rehash at most once for the whole batch.
+        _idMap.reserve(_idMap.size() + count);
+        _views.reserve(_views.size() + count);
+
+        for (size_t i = 0; i < count; i++)
+            pIds[i] = InternLocked(pViews[i]);
+    }
+
+    std::string_view StringPool::CopyToArena(std::string_view str)
+    {
+        if (str.empty())
+            return {};
+
+        char* pDest;
+        if (str.size() > _config.blockSize / 4)
+        {
+            // Long strings would waste the rest of a shared block, the current block stays in use.
+            _blocks.push_back(std::make_unique_for_overwrite<char[]>(str.size()));
+            pDest = _blocks.back().get();
+            _arenaSize += str.size();
+        }
+        else
+        {
+            if (str.size() > _blockRemain)
+            {
+                _blocks.push_back(std::make_unique_for_overwrite<char[]>(_config.blockSize));
+                _pBlockCurrent = _blocks.back().get();
+                _blockRemain = _config.blockSize;
+                _arenaSize += _config.blockSize;
+            }
+
+            pDest = _pBlockCurrent;
+            _pBlockCurrent += str.size();
+            _blockRemain -= str.size();
+        }
+
+        std::memcpy(pDest, str.data(), str.size());
+        return { pDest, str.size() };
+    }
+}
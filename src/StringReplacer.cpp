@@ -0,0 +1,205 @@
+#include <queue>
+#include <iterator>
+#include <algorithm>
+#include "Infra/Utility/String.h"
+#include "Infra/Utility/StringReplacer.h"
+
+namespace Infra
+{
+    StringReplacer::StringReplacer(const std::vector<Pair>& pairs)
+        : _byteClass{}
+        , _rowSize(ROW_HEADER_SIZE + 1)
+        , _startByte{}
+    {
+        // Class 0 is every byte that no pattern uses, stored as its offset inside a row.
+        for (auto& byteClass : _byteClass)
+            byteClass = ROW_HEADER_SIZE;
+
+        for (const auto& pair : pairs)
+        {
+            if (pair.first.empty())
+                continue;
+
+            _pairs.push_back(pair);
+            _startByte[static_cast<uint8_t>(pair.first[0])] = true;
+            for (const char ch : pair.first)
+            {
+                auto& byteClass = _byteClass[static_cast<uint8_t>(ch)];
+                if (byteClass == ROW_HEADER_SIZE)
+                    byteClass = static_cast<uint16_t>(_rowSize++);
+            }
+        }
+
+        if (std::count(std::begin(_startByte), std::end(_startByte), true) == 1)
+            _singleStartByte = _pairs[0].first[0];
+
+        Build();
+    }
+
+    uint32_t StringReplacer::AddNode(uint32_t depth)
+    {
+        const auto row = static_cast<uint32_t>(_table.size());
+        _table.resize(_table.size() + _rowSize, 0);
+        _table[row + ROW_DEPTH] = depth;
+        _table[row + ROW_PATTERN] = NO_PATTERN;
+        return row;
+    }
+
+    void StringReplacer::Build()
+    {
+        // Root is row 0, it never ends a pattern so 0 also means "no node" in links.
+        AddNode(0);
+
+        for (uint32_t i = 0; i < _pairs.size(); i++)
+        {
+            uint32_t row = 0;
+            for (const char ch : _pairs[i].first)
+            {
+                const size_t index = row + _byteClass[static_cast<uint8_t>(ch)];
+                if (_table[index] == 0)
+                {
+                    const uint32_t child = AddNode(_table[row + ROW_DEPTH] + 1);
+                    _table[index] = child;
+                }
+
+                row = _table[index];
+            }
+
+            if (_table[row + ROW_PATTERN] == NO_PATTERN)
+                _table[row + ROW_PATTERN] = i;
+        }
+
+        // Breadth first, failure links of shallower nodes are final when a node is visited.
+        // Missing transitions are filled from the failure node, which makes the table a dfa.
+        std::vector<uint32_t> failure(_table.size() / _rowSize, 0);
+        std::queue<uint32_t> rowQueue;
+        for (uint32_t c = ROW_HEADER_SIZE; c < _rowSize; c++)
+        {
+            if (const uint32_t child = _table[c]; child != 0)
+                rowQueue.push(child);
+        }
+
+        while (!rowQueue.empty())
+        {
+            const uint32_t row = rowQueue.front();
+            rowQueue.pop();
+
+            const uint32_t failureRow = failure[row / _rowSize];
+            for (uint32_t c = ROW_HEADER_SIZE; c < _rowSize; c++)
+            {
+                const uint32_t fallback = _table[failureRow + c];
+                const uint32_t child = _table[row + c];
+                if (child == 0)
+                {
+                    _table[row + c] = fallback;
+                    continue;
+                }
+
+                failure[child / _rowSize] = fallback;
+                _table[child + ROW_OUTPUT] = _table[fallback + ROW_PATTERN] != NO_PATTERN ? fallback : _table[fallback + ROW_OUTPUT];
+                rowQueue.push(child);
+            }
+        }
+    }
+
+    size_t StringReplacer::SkipToStartByte(std::string_view inStr, size_t pos) const
+    {
+        if (_singleStartByte.has_value())
+        {
+            const char* pEnd = inStr.data() + inStr.size();
+            return String::FindByte(inStr.data() + pos, pEnd, *_singleStartByte) - inStr.data();
+        }
+
+        while (pos < inStr.size() && !_startByte[static_cast<uint8_t>(inStr[pos])])
+            pos++;
+
+        return pos;
+    }
+
+    void StringReplacer::FindMatches(std::string_view inStr, std::vector<Match>& matchVec) const
+    {
+        const uint32_t* pTable = _table.data();
+        uint32_t row = 0;
+
+        // A match is only final once no match can start at or before it any more.
+        bool hasCandidate = false;
+        Match candidate {};
+
+        size_t i = 0;
+        while (true)
+        {
+            // Nothing pending at the root, jump to the next byte that can start a pattern.
+            if (row == 0 && !hasCandidate)
+                i = SkipToStartByte(inStr, i);
+
+            const bool atEnd = i == inStr.size();
+            if (!atEnd)
+                row = pTable[row + _byteClass[static_cast<uint8_t>(inStr[i])]];
+
+            if (hasCandidate && (atEnd || candidate.position < i + 1 - pTable[row + ROW_DEPTH]))
+            {
+                matchVec.push_back(candidate);
+                hasCandidate = false;
+
+                // Restart right after the match, matches overlapping it are dropped and the ones
+                // passed over while it was pending are found again. Rescans at most the longest pattern.
+                row = 0;
+                i = candidate.position + _pairs[candidate.pattern].first.size();
+                continue;
+            }
+
+            if (atEnd)
+                break;
+
+            // Longest pattern ending here, it has the leftmost start.
+            const uint32_t outputRow = pTable[row + ROW_PATTERN] != NO_PATTERN ? row : pTable[row + ROW_OUTPUT];
+            if (outputRow != 0)
+            {
+                const size_t start = i + 1 - pTable[outputRow + ROW_DEPTH];
+                if (!hasCandidate || start <= candidate.position)
+                {
+                    candidate = Match { start, pTable[outputRow + ROW_PATTERN] };
+                    hasCandidate = true;
+                }
+            }
+
+            i++;
+        }
+    }
+
+    std::string StringReplacer::Replace(std::string_view inStr) const
+    {
+        std::string result;
+        Replace(inStr, result);
+        return result;
+    }
+
+    void StringReplacer::Replace(std::string_view inStr, std::string& output) const
+    {
+        std::vector<Match> matchVec;
+        if (!_pairs.empty())
+            FindMatches(inStr, matchVec);
+
+        size_t size = inStr.size();
+        for (const auto& match : matchVec)
+            size = size - _pairs[match.pattern].first.size() + _pairs[match.pattern].second.size();
+
+        output.reserve(output.size() + size);
+
+        size_t copyPos = 0;
+        for (const auto& match : matchVec)
+        {
+            const auto& [from, to] = _pairs[match.pattern];
+            output.append(inStr.substr(copyPos, match.position - copyPos));
+            output.append(to);
+            copyPos = match.position + from.size();
+        }
+
+        output.append(inStr.substr(copyPos));
+    }
+
+    size_t StringReplacer::GetPatternCount() const
+    {
+        return _pairs.size();
+    }
+}
@@ -3,8 +3,9 @@
 #if PLATFORM_SUPPORT_POSIX
 
 #include <sys/mman.h>
+#include <fcntl.h>
 #include <unistd.h>
-#include "Infra/Memory.hpp"
+#include "Infra/System/Memory.h"
 
 #if PLATFORM_IOS || PLATFORM_MAC
 #include <mach/vm_page_size.h>
@@ -36,6 +37,26 @@ namespace Infra
         return ::sysconf(_SC_PAGE_SIZE);
 #endif
     }
+
+    void* Memory::MapFile(const std::string& path, size_t size)
+    {
+        const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0)
+            return nullptr;
+
+        void* result = MAP_FAILED;
+        if (::ftruncate(fd, static_cast<off_t>(size)) == 0)
+            result = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+        // Mapping keeps its own reference to the file.
+        ::close(fd);
+        return result == MAP_FAILED ? nullptr : result;
+    }
+
+    void Memory::UnmapFile(void* addr, size_t size)
+    {
+        ::munmap(addr, size);
+    }
 }
 
 #endif
\ No newline at end of file
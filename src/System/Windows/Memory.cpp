@@ -2,6 +2,7 @@
 
 #if PLATFORM_WINDOWS
 
+#include <filesystem>
 #include "Infra/Platform/Windows/WindowsDefine.h"
 #include "Infra/System/Memory.h"
 
@@ -33,6 +34,35 @@ namespace Infra
         ::GetSystemInfo(&sysInfo);
         return sysInfo.dwPageSize;
     }
+
+    void* Memory::MapFile(const std::string& path, size_t size)
+    {
+        HANDLE hFile = ::CreateFileW(std::filesystem::path(path).c_str(), GENERIC_READ | GENERIC_WRITE,
+                                     FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                     nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (hFile == INVALID_HANDLE_VALUE)
+            return nullptr;
+
+        // Mapping object grows the file to size if it is smaller.
+        const uint64_t mappingSize = size;
+        HANDLE hMapping = ::CreateFileMappingW(hFile, nullptr, PAGE_READWRITE,
+                                               static_cast<DWORD>(mappingSize >> 32),
+                                               static_cast<DWORD>(mappingSize & 0xFFFFFFFF), nullptr);
+        ::CloseHandle(hFile);
+        if (hMapping == nullptr)
+            return nullptr;
+
+        // View keeps its own reference to the mapping object.
+        void* result = ::MapViewOfFile(hMapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+        ::CloseHandle(hMapping);
+        return result;
+    }
+
+    void Memory::UnmapFile(void* addr, size_t size)
+    {
+        (void)size; // size used in POSIX
+        ::UnmapViewOfFile(addr);
+    }
 }
 
 #endif
\ No newline at end of file
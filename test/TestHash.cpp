@@ -0,0 +1,87 @@
+#include <array>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <unordered_set>
+#include <unordered_map>
+#include "DocTest.h"
+#include "Infra/Utility/Hash.h"
+
+// Printable and high bytes, so sign extension of char would change the result.
+static constexpr char TEXT[] =
+    "The quick brown fox jumps over the lazy dog \xe6\xb5\x8b\xe8\xaf\x95 \xff\x80\x7f"
+    "0123456789 ABCDEFGHIJKLMNOPQRSTUVWXYZ abcdefghijklmnopqrstuvwxyz !?";
+
+static constexpr size_t TEXT_SIZE = sizeof(TEXT) - 1;
+
+static constexpr std::array<uint64_t, TEXT_SIZE + 1> COMPILE_TIME_HASHES = []()
+{
+    std::array<uint64_t, TEXT_SIZE + 1> hashes {};
+    for (size_t size = 0; size <= TEXT_SIZE; size++)
+        hashes[size] = Infra::Hash::Of(std::string_view(TEXT, size), size);
+
+    return hashes;
+}();
+
+static const char* CommandName(std::string_view command)
+{
+    switch (Infra::Hash::Of(command))
+    {
+        case Infra::Hash::Of("start"):
+            return "start";
+        case Infra::Hash::Of("stop"):
+            return "stop";
+        default:
+            return "unknown";
+    }
+}
+
+TEST_CASE("Compile time and runtime hashes agree at every size")
+{
+    static_assert(TEXT_SIZE > 100);
+
+    for (size_t size = 0; size <= TEXT_SIZE; size++)
+    {
+        // Heap copy, so the runtime path reads from an unrelated address.
+        const std::string copy(TEXT, size);
+        CHECK(Infra::Hash::Of(copy, size) == COMPILE_TIME_HASHES[size]);
+        CHECK(Infra::Hash::Bytes(copy.data(), copy.size(), size) == COMPILE_TIME_HASHES[size]);
+        CHECK(Infra::Hash::Bytes(std::as_bytes(std::span(copy)), size) == COMPILE_TIME_HASHES[size]);
+    }
+
+    CHECK(std::string_view(CommandName("start")) == "start");
+    CHECK(std::string_view(CommandName(std::string("stop"))) == "stop");
+    CHECK(std::string_view(CommandName("restart")) == "unknown");
+}
+
+TEST_CASE("Hash separates similar keys and seeds")
+{
+    std::unordered_set<uint64_t> seen;
+    for (int i = 0; i < 100000; i++)
+        seen.insert(Infra::Hash::Of("option-" + std::to_string(i)));
+
+    CHECK(seen.size() == 100000);
+
+    // Every size class and a flipped last byte.
+    for (size_t size = 1; size <= TEXT_SIZE; size++)
+    {
+        std::string changed(TEXT, size);
+        changed.back() ^= 1;
+        CHECK(Infra::Hash::Of(changed) != Infra::Hash::Of(std::string_view(TEXT, size)));
+        CHECK(Infra::Hash::Of(std::string_view(TEXT, size), 1) != Infra::Hash::Of(std::string_view(TEXT, size), 2));
+    }
+
+    CHECK(Infra::Hash::Combine(1, 2) != Infra::Hash::Combine(2, 1));
+}
+
+TEST_CASE("StringHash finds std::string keys by string_view")
+{
+    std::unordered_map<std::string, int, Infra::StringHash, std::equal_to<>> map;
+    map["name"] = 1;
+    map["port"] = 2;
+
+    const std::string_view key = "--port";
+    CHECK(map.find(key.substr(2))->second == 2);
+    CHECK(map.contains("name"));
+    CHECK_FALSE(map.contains(std::string_view("nam")));
+}
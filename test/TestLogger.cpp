@@ -0,0 +1,1002 @@
+#include <atomic>
+#include <charconv>
+#include <mutex>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <unordered_set>
+#include "DocTest.h"
+#include "Infra/PlatformDefine.h"
+#include "Infra/Utility/Logger.h"
+#include "Infra/Utility/LogFileSink.h"
+#include "Infra/Utility/LogSampling.h"
+#include "Infra/Utility/LogNetworkSink.h"
+
+#if PLATFORM_SUPPORT_POSIX
+#   include <csignal>
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <sys/wait.h>
+#   include <sys/socket.h>
+#   include <netinet/in.h>
+#endif
+
+static std::atomic<int> gInfoCount = 0;
+
+static void CountInfo(const char* message)
+{
+    (void)message;
+    gInfoCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void RegisterCountInfo()
+{
+    static bool registered = false;
+    if (!registered)
+    {
+        Infra::Logger::AddLogCall<Infra::Logger::Level::Info>(CountInfo);
+        registered = true;
+    }
+}
+
+TEST_CASE("Async logger delivers every message with block policy")
+{
+    RegisterCountInfo();
+    gInfoCount = 0;
+
+    Infra::Logger::AsyncConfig config;
+    config.queueCapacity = 64;
+    config.overflowPolicy = Infra::Logger::OverflowPolicy::Block;
+    CHECK(Infra::Logger::StartAsync(config));
+    CHECK(Infra::Logger::IsAsync());
+
+    constexpr int threadCount = 4;
+    constexpr int messagePerThread = 5000;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back([]() -> void
+        {
+            for (int j = 0; j < messagePerThread; j++)
+                Infra::Logger::LogInfo("message");
+        });
+    }
+
+    for (auto& t: threads)
+        t.join();
+
+    Infra::Logger::Flush();
+    CHECK(gInfoCount.load() == threadCount * messagePerThread);
+
+    Infra::Logger::StopAsync();
+    CHECK_FALSE(Infra::Logger::IsAsync());
+}
+
+TEST_CASE("Stopping async mode loses no message of racing producers")
+{
+    RegisterCountInfo();
+    gInfoCount = 0;
+
+    Infra::Logger::AsyncConfig config;
+    config.queueCapacity = 16;
+    config.overflowPolicy = Infra::Logger::OverflowPolicy::Block;
+
+    constexpr int threadCount = 4;
+    constexpr int messagePerThread = 20000;
+
+    std::atomic<int> running = threadCount;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back([&]() -> void
+        {
+            for (int j = 0; j < messagePerThread; j++)
+                Infra::Logger::LogInfo("message");
+
+            running--;
+        });
+    }
+
+    // Each message goes either through a queue or straight to the callback, never nowhere.
+    while (running.load() > 0)
+    {
+        Infra::Logger::StartAsync(config);
+        std::this_thread::yield();
+        Infra::Logger::StopAsync();
+    }
+
+    for (auto& t: threads)
+        t.join();
+
+    CHECK(gInfoCount.load() == threadCount * messagePerThread);
+}
+
+// Logs and flushes from the async worker for every batch holding records of the main thread.
+class FloodingSink : public Infra::LogSink
+{
+public:
+    void OnBatch(std::span<const Infra::LogRecord> records) override
+    {
+        int outer = 0;
+        for (const auto& record: records)
+        {
+            if (record.message == "outer")
+                outer++;
+            else if (record.message == "nested")
+                nestedCount++;
+        }
+
+        outerCount += outer;
+        if (outer == 0)
+            return;
+
+        for (int i = 0; i < 8; i++)
+        {
+            Infra::Logger::LogInfo("nested");
+            nestedLogged++;
+        }
+
+        Infra::Logger::Flush();
+    }
+
+public:
+    std::atomic<int> outerCount = 0;
+    std::atomic<int> nestedCount = 0;
+    std::atomic<int> nestedLogged = 0;
+};
+
+TEST_CASE("Sinks can log and flush on the async worker with a full blocking queue")
+{
+    auto pSink = std::make_shared<FloodingSink>();
+    Infra::Logger::AddSink(pSink);
+
+    Infra::Logger::AsyncConfig config;
+    config.queueCapacity = 4;
+    config.overflowPolicy = Infra::Logger::OverflowPolicy::Block;
+    REQUIRE(Infra::Logger::StartAsync(config));
+
+    const uint64_t droppedBefore = Infra::Logger::GetAsyncOverflowCount().droppedNewest;
+    for (int i = 0; i < 100; i++)
+        Infra::Logger::LogInfo("outer");
+
+    Infra::Logger::Flush();
+    Infra::Logger::StopAsync();
+    Infra::Logger::RemoveSink(pSink);
+
+    // Records of the worker that found the queue full are dropped, nothing else is lost.
+    const uint64_t dropped = Infra::Logger::GetAsyncOverflowCount().droppedNewest - droppedBefore;
+    CHECK(pSink->outerCount.load() == 100);
+    CHECK(pSink->nestedCount.load() + dropped == static_cast<uint64_t>(pSink->nestedLogged.load()));
+}
+
+TEST_CASE("Async logger counts dropped messages")
+{
+    gInfoCount = 0;
+
+    Infra::Logger::AsyncConfig config;
+    config.queueCapacity = 16;
+    config.overflowPolicy = Infra::Logger::OverflowPolicy::DropNewest;
+    CHECK(Infra::Logger::StartAsync(config));
+
+    constexpr int messageCount = 100000;
+    for (int i = 0; i < messageCount; i++)
+        Infra::Logger::LogInfo("message");
+
+    Infra::Logger::StopAsync();
+
+    auto overflow = Infra::Logger::GetAsyncOverflowCount();
+    CHECK(gInfoCount.load() + overflow.droppedNewest == messageCount);
+}
+
+class CountBatchSink : public Infra::LogSink
+{
+public:
+    void OnBatch(std::span<const Infra::LogRecord> records) override
+    {
+        batchCount++;
+        for (const auto& record: records)
+        {
+            if (record.message == "batched")
+                recordCount++;
+        }
+    }
+
+public:
+    int batchCount = 0;
+    int recordCount = 0;
+};
+
+TEST_CASE("Batch sink receives staged records in sync mode")
+{
+    auto pSink = std::make_shared<CountBatchSink>();
+    Infra::Logger::AddSink(pSink);
+
+    Infra::Logger::BatchConfig config;
+    config.stagingRecordCount = 100;
+    config.maxStagingDelayMs = 60 * 1000;
+    Infra::Logger::SetBatchConfig(config);
+
+    for (int i = 0; i < 1000; i++)
+        Infra::Logger::LogInfo("batched");
+
+    Infra::Logger::Flush();
+    CHECK(pSink->recordCount == 1000);
+    CHECK(pSink->batchCount == 10);
+
+    Infra::Logger::RemoveSink(pSink);
+    Infra::Logger::SetBatchConfig(Infra::Logger::BatchConfig{});
+}
+
+// Logs from inside OnBatch once, sinks are called from the flusher thread too.
+class ReentrantSink : public Infra::LogSink
+{
+public:
+    void OnBatch(std::span<const Infra::LogRecord> records) override
+    {
+        std::vector<std::string> copied;
+        for (const auto& record: records)
+            copied.emplace_back(record.message);
+
+        bool logNested = false;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            messages.insert(messages.end(), copied.begin(), copied.end());
+            logNested = !logged;
+            logged = true;
+        }
+
+        if (logNested)
+            Infra::Logger::LogError("from sink");
+    }
+
+    size_t Count()
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        return messages.size();
+    }
+
+public:
+    std::mutex mutex;
+    bool logged = false;
+    std::vector<std::string> messages;
+};
+
+TEST_CASE("Staged records are flushed after the delay without another log")
+{
+    auto pSink = std::make_shared<ReentrantSink>();
+    Infra::Logger::AddSink(pSink);
+
+    Infra::Logger::BatchConfig config;
+    config.maxStagingDelayMs = 20;
+    Infra::Logger::SetBatchConfig(config);
+
+    Infra::Logger::LogInfo("idle");
+
+    // Nothing else is logged by this thread, the flusher delivers both records.
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (pSink->Count() < 2 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    Infra::Logger::RemoveSink(pSink);
+    Infra::Logger::SetBatchConfig(Infra::Logger::BatchConfig{});
+
+    std::lock_guard<std::mutex> guard(pSink->mutex);
+    REQUIRE(pSink->messages.size() == 2);
+    CHECK(pSink->messages[0] == "idle");
+    CHECK(pSink->messages[1] == "from sink");
+}
+
+TEST_CASE("Batch sink receives drained records in async mode")
+{
+    auto pSink = std::make_shared<CountBatchSink>();
+    Infra::Logger::AddSink(pSink);
+    CHECK(Infra::Logger::StartAsync());
+
+    for (int i = 0; i < 1000; i++)
+        Infra::Logger::LogWarn("batched");
+
+    Infra::Logger::Flush();
+    Infra::Logger::StopAsync();
+    CHECK(pSink->recordCount == 1000);
+    CHECK(pSink->batchCount <= 1000);
+
+    Infra::Logger::RemoveSink(pSink);
+}
+
+// Batches of different threads' staging buffers may arrive concurrently.
+class CollectSink : public Infra::LogSink
+{
+public:
+    void OnBatch(std::span<const Infra::LogRecord> records) override
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        for (const auto& record: records)
+            messages.emplace_back(record.message);
+    }
+
+    size_t CountPrefix(std::string_view prefix)
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        return std::count_if(messages.begin(), messages.end(), [&](const std::string& message) -> bool
+        {
+            return message.starts_with(prefix);
+        });
+    }
+
+public:
+    std::mutex mutex;
+    std::vector<std::string> messages;
+};
+
+TEST_CASE("Deferred format arguments outlive the caller")
+{
+    auto pSink = std::make_shared<CollectSink>();
+    Infra::Logger::AddSink(pSink);
+    CHECK(Infra::Logger::StartAsync());
+
+    for (int i = 0; i < 3; i++)
+    {
+        std::string temp = "temp" + std::to_string(i);
+        const char* pTemp = temp.c_str();
+        Infra::Logger::LogInfo("{} {} {:.1f} {}", pTemp, i, 0.5, std::string_view(temp));
+    }
+
+    Infra::Logger::Flush();
+    Infra::Logger::StopAsync();
+    Infra::Logger::RemoveSink(pSink);
+
+    REQUIRE(pSink->messages.size() == 3);
+    CHECK(pSink->messages[0] == "temp0 0 0.5 temp0");
+    CHECK(pSink->messages[2] == "temp2 2 0.5 temp2");
+}
+
+static int CountEvaluation(int& counter)
+{
+    return ++counter;
+}
+
+TEST_CASE("Disabled level does not evaluate macro arguments")
+{
+    auto pSink = std::make_shared<CollectSink>();
+    Infra::Logger::AddSink(pSink);
+    Infra::Logger::SetFilterLevel(Infra::Logger::Level::Info);
+
+    int counter = 0;
+    INFRA_LOG_DEBUG("debug {}", CountEvaluation(counter));
+    CHECK(counter == 0);
+
+    Infra::Logger::SetFilterLevel(Infra::Logger::Level::Trace);
+    INFRA_LOG_TRACE("trace {}", CountEvaluation(counter));
+    CHECK(counter == (INFRA_LOG_MIN_LEVEL <= INFRA_LOG_LEVEL_TRACE ? 1 : 0));
+
+    Infra::Logger::SetFilterLevel(Infra::Logger::Level::Info);
+    Infra::Logger::Flush();
+    Infra::Logger::RemoveSink(pSink);
+}
+
+static std::atomic<int> gRecordLine = 0;
+
+static void CaptureRecordLine(const Infra::LogRecord& record)
+{
+    gRecordLine = static_cast<int>(record.location.line());
+}
+
+TEST_CASE("Record callback receives call site and timestamp")
+{
+    Infra::Logger::AddLogCall<Infra::Logger::Level::Warning>(CaptureRecordLine);
+
+    const int line = __LINE__ + 1;
+    Infra::Logger::LogWarn("location {}", 1);
+    CHECK(gRecordLine.load() == line);
+
+    char buffer[Infra::Logger::TIMESTAMP_SIZE + 1];
+    const int64_t now = Infra::Logger::GetCoarseTimestamp();
+    CHECK(Infra::Logger::FormatTimestamp(now, buffer, sizeof(buffer)) == Infra::Logger::TIMESTAMP_SIZE);
+    CHECK(buffer[4] == '-');
+    CHECK(buffer[19] == '.');
+    CHECK(Infra::Logger::FormatTimestamp(now + 1000, buffer, sizeof(buffer)) == Infra::Logger::TIMESTAMP_SIZE);
+    CHECK(Infra::Logger::FormatTimestamp(now, buffer, 8) == 0);
+}
+
+TEST_CASE("File sink writes lines and rotates by size")
+{
+    const auto directory = std::filesystem::temp_directory_path() / "infra_test_logger";
+    std::filesystem::remove_all(directory);
+
+    Infra::LogFileSink::Config config;
+    config.directory = directory.string();
+    config.baseName = "test";
+    config.maxFileSize = 4096;
+    config.maxFileCount = 3;
+
+    auto pSink = std::make_shared<Infra::LogFileSink>(config);
+    REQUIRE(pSink->IsOpen());
+    Infra::Logger::AddSink(pSink);
+
+    for (int i = 0; i < 1000; i++)
+        Infra::Logger::LogInfo("file sink line {}", i);
+
+    Infra::Logger::Flush();
+    Infra::Logger::RemoveSink(pSink);
+
+    size_t fileCount = 0;
+    for (const auto& entry: std::filesystem::directory_iterator(directory))
+    {
+        fileCount++;
+        CHECK(entry.file_size() <= config.maxFileSize);
+    }
+
+    CHECK(fileCount == config.maxFileCount + 1);
+
+    std::ifstream activeFile(pSink->GetFilePath());
+    std::string line, lastLine;
+    while (std::getline(activeFile, line))
+        lastLine = line;
+
+    CHECK(lastLine.find("[INFO]") != std::string::npos);
+    CHECK(lastLine.ends_with("file sink line 999"));
+
+    pSink.reset();
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("File sinks sharing a directory keep only their own rotated files")
+{
+    const auto directory = std::filesystem::temp_directory_path() / "infra_test_logger_shared";
+    std::filesystem::remove_all(directory);
+
+    Infra::LogFileSink::Config config;
+    config.directory = directory.string();
+    config.maxFileSize = 4096;
+    config.maxFileCount = 2;
+
+    config.baseName = "app";
+    auto pAppSink = std::make_shared<Infra::LogFileSink>(config);
+    config.baseName = "app.audit";
+    auto pAuditSink = std::make_shared<Infra::LogFileSink>(config);
+
+    // The app sink rotates after the audit sink, its retention runs last.
+    Infra::Logger::AddSink(pAuditSink);
+    Infra::Logger::AddSink(pAppSink);
+
+    for (int i = 0; i < 1000; i++)
+        Infra::Logger::LogInfo("shared directory line {}", i);
+
+    Infra::Logger::Flush();
+    Infra::Logger::RemoveSink(pAppSink);
+    Infra::Logger::RemoveSink(pAuditSink);
+
+    size_t appFileCount = 0;
+    size_t auditFileCount = 0;
+    for (const auto& entry: std::filesystem::directory_iterator(directory))
+    {
+        const std::string name = entry.path().filename().string();
+        if (name.starts_with("app.audit."))
+            auditFileCount++;
+        else if (name.starts_with("app."))
+            appFileCount++;
+    }
+
+    // The active file and maxFileCount rotated files for each sink.
+    CHECK(std::filesystem::exists(pAppSink->GetFilePath()));
+    CHECK(std::filesystem::exists(pAuditSink->GetFilePath()));
+    CHECK(appFileCount == config.maxFileCount + 1);
+    CHECK(auditFileCount == config.maxFileCount + 1);
+
+    pAppSink.reset();
+    pAuditSink.reset();
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("File sink writes delayed lines without a flush and reopens a failed file")
+{
+    const auto directory = std::filesystem::temp_directory_path() / "infra_test_logger_retry";
+    std::filesystem::remove_all(directory);
+
+    // A regular file in place of the directory makes the first open fail.
+    std::ofstream(directory).put('x');
+
+    Infra::LogFileSink::Config config;
+    config.directory = directory.string();
+    config.baseName = "test";
+    config.maxBufferDelayMs = 20;
+
+    auto pSink = std::make_shared<Infra::LogFileSink>(config);
+    CHECK_FALSE(pSink->IsOpen());
+
+    // Past the first retry delay, the next write opens the file again.
+    std::filesystem::remove(directory);
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+
+    Infra::Logger::AddSink(pSink);
+    Infra::Logger::LogInfo("delayed line");
+
+    // No Flush, the line is written by the logger's background thread.
+    bool written = false;
+    for (int i = 0; i < 200 && !written; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        std::ifstream file(pSink->GetFilePath());
+        std::stringstream content;
+        content << file.rdbuf();
+        written = content.str().find("delayed line") != std::string::npos;
+    }
+
+    CHECK(written);
+    CHECK(pSink->IsOpen());
+
+    Infra::Logger::RemoveSink(pSink);
+    pSink.reset();
+    std::filesystem::remove_all(directory);
+}
+
+// Keeps the sequence numbers it receives and counts batches arriving after it was marked removed.
+class SequenceSink : public Infra::LogSink
+{
+public:
+    void OnBatch(std::span<const Infra::LogRecord> records) override
+    {
+        if (removed.load())
+            lateBatchCount.fetch_add(1);
+
+        std::lock_guard<std::mutex> guard(_mutex);
+        for (const auto& record: records)
+        {
+            int sequence = 0;
+            const char* pEnd = record.message.data() + record.message.size();
+            const auto result = std::from_chars(record.message.data(), pEnd, sequence);
+            if (result.ec == std::errc() && result.ptr == pEnd)
+                _received.insert(sequence);
+        }
+    }
+
+    bool ReceivedAll(int first, int last) const
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+        for (int i = first; i < last; i++)
+        {
+            if (!_received.contains(i))
+                return false;
+        }
+
+        return true;
+    }
+
+public:
+    std::atomic<bool> removed = false;
+    std::atomic<int> lateBatchCount = 0;
+
+private:
+    mutable std::mutex _mutex;
+    std::unordered_set<int> _received;
+};
+
+TEST_CASE("Sinks can be added and removed while other threads log")
+{
+    std::atomic<int> sequence = 0;
+    std::atomic<bool> stop = false;
+    std::vector<std::thread> threads;
+
+    auto startLogging = [&]() -> void
+    {
+        stop = false;
+        for (int i = 0; i < 4; i++)
+        {
+            threads.emplace_back([&]() -> void
+            {
+                while (!stop.load())
+                    Infra::Logger::LogInfo("{}", sequence.fetch_add(1));
+            });
+        }
+    };
+
+    auto stopLogging = [&]() -> void
+    {
+        stop = true;
+        for (auto& t: threads)
+            t.join();
+
+        threads.clear();
+    };
+
+    // A number taken after AddSink returned is logged after it, so the sink must receive it.
+    startLogging();
+    std::vector<std::shared_ptr<SequenceSink>> sinks;
+    std::vector<int> addedAt;
+    for (int i = 0; i < 16; i++)
+    {
+        sinks.push_back(std::make_shared<SequenceSink>());
+        Infra::Logger::AddSink(sinks.back());
+        addedAt.push_back(sequence.load());
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    stopLogging();
+    Infra::Logger::Flush();
+
+    const int last = sequence.load();
+    for (size_t i = 0; i < sinks.size(); i++)
+        CHECK(sinks[i]->ReceivedAll(addedAt[i], last));
+
+    // After RemoveSink returns the sink is neither called nor referenced by the logger.
+    startLogging();
+    for (const auto& pSink: sinks)
+    {
+        Infra::Logger::RemoveSink(pSink);
+        pSink->removed = true;
+        CHECK(pSink.use_count() == 1);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    stopLogging();
+    Infra::Logger::Flush();
+
+    for (const auto& pSink: sinks)
+        CHECK(pSink->lateBatchCount.load() == 0);
+}
+
+TEST_CASE("Sampling macros limit messages per call site")
+{
+    auto pSink = std::make_shared<CollectSink>();
+    Infra::Logger::AddSink(pSink);
+
+    for (int i = 0; i < 100; i++)
+        INFRA_LOG_EVERY_N(Info, 10, "every n {}", i);
+
+    for (int i = 0; i < 100; i++)
+        INFRA_LOG_FIRST_N(Info, 3, "first n {}", i);
+
+    auto rateLimitedSite = [](int i) -> void
+    {
+        INFRA_LOG_RATE_LIMITED(Info, 1.0, 5, "rate limited {}", i);
+    };
+
+    for (int i = 0; i < 100; i++)
+        rateLimitedSite(i);
+
+    // The site is not called again, its summary comes from the background thread once the window reopens.
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (pSink->CountPrefix("Suppressed 95 messages") == 0 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    // The summary took the reopened slot, this call is suppressed and reported by Flush.
+    rateLimitedSite(100);
+
+    INFRA_LOG_EVERY_T(Info, 3600.0, "every t");
+    INFRA_LOG_EVERY_T(Info, 3600.0, "every t");
+
+    Infra::Logger::Flush();
+    Infra::Logger::RemoveSink(pSink);
+
+    CHECK(pSink->CountPrefix("every n ") == 10);
+    CHECK(pSink->CountPrefix("first n ") == 3);
+    CHECK(pSink->CountPrefix("rate limited ") == 5);
+    CHECK(pSink->CountPrefix("Suppressed 95 messages") == 1);
+    CHECK(pSink->CountPrefix("Suppressed 1 messages") == 1);
+    CHECK(pSink->CountPrefix("every t") == 2);
+}
+
+INFRA_LOG_CATEGORY(TestNetwork, 1);
+
+TEST_CASE("Category ids are owned by the first registered category")
+{
+    static constexpr Infra::LogCategory COLLIDING_CATEGORY { 1, "Colliding" };
+    static constexpr Infra::LogCategory UNUSED_CATEGORY { 200, "Unused" };
+
+    CHECK(Infra::Logger::RegisterCategory(TestNetwork));
+    CHECK_FALSE(Infra::Logger::RegisterCategory(COLLIDING_CATEGORY));
+    CHECK_FALSE(Infra::Logger::RegisterCategory(Infra::LogCategory { 0, "Default" }));
+    CHECK(Infra::Logger::RegisterCategory(UNUSED_CATEGORY));
+    CHECK(Infra::Logger::RegisterCategory(UNUSED_CATEGORY));
+}
+
+TEST_CASE("Category level overrides global level")
+{
+    auto pSink = std::make_shared<CollectSink>();
+    Infra::Logger::AddSink(pSink);
+    Infra::Logger::SetFilterLevel(Infra::Logger::Level::Info);
+    Infra::Logger::SetCategoryLevel(TestNetwork, Infra::Logger::Level::Trace);
+
+    INFRA_LOG_CAT(TestNetwork, Trace, "network {}", 1);
+    INFRA_LOG_TRACE("global {}", 1);
+    CHECK(Infra::Logger::IsEnabled(TestNetwork, Infra::Logger::Level::Trace) == (INFRA_LOG_MIN_LEVEL <= INFRA_LOG_LEVEL_TRACE));
+    CHECK_FALSE(Infra::Logger::IsEnabled(Infra::Logger::Level::Trace));
+
+    // Override survives global changes until reset.
+    Infra::Logger::SetFilterLevel(Infra::Logger::Level::Error);
+    CHECK(Infra::Logger::GetCategoryLevel(TestNetwork) == Infra::Logger::Level::Trace);
+    Infra::Logger::ResetCategoryLevel(TestNetwork);
+    CHECK(Infra::Logger::GetCategoryLevel(TestNetwork) == Infra::Logger::Level::Error);
+    INFRA_LOG_CAT(TestNetwork, Warning, "network {}", 2);
+
+    Infra::Logger::SetFilterLevel(Infra::Logger::Level::Info);
+    Infra::Logger::Flush();
+    Infra::Logger::RemoveSink(pSink);
+
+    const size_t expected = INFRA_LOG_MIN_LEVEL <= INFRA_LOG_LEVEL_TRACE ? 1 : 0;
+    REQUIRE(pSink->messages.size() == expected);
+    if (expected == 1)
+        CHECK(pSink->messages[0] == "network 1");
+}
+
+// Holds the async worker inside the sink, so records logged afterwards stay queued.
+class BlockingSink : public Infra::LogSink
+{
+public:
+    void OnBatch(std::span<const Infra::LogRecord> records) override
+    {
+        (void)records;
+        entered = true;
+        while (true)
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+
+public:
+    std::atomic<bool> entered = false;
+};
+
+TEST_CASE("Flight recorder keeps records across wrap and crash")
+{
+    const auto directory = std::filesystem::temp_directory_path() / "infra_test_flight_recorder";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const std::string path = (directory / "recorder.bin").string();
+
+    REQUIRE(Infra::Logger::EnableFlightRecorder(path, 8192));
+    for (int i = 0; i < 500; i++)
+        Infra::Logger::LogInfo("recorder line {}", i);
+    Infra::Logger::DisableFlightRecorder();
+
+    const std::string content = Infra::Logger::ReadFlightRecorder(path);
+    CHECK(content.find("recorder line 499\n") != std::string::npos);
+    CHECK(content.find("recorder line 0\n") == std::string::npos);
+    CHECK(content.find("[INFO]") < content.find('\n'));
+
+    // Sanitizers keep their own SIGSEGV handler and ignore ours.
+#if PLATFORM_SUPPORT_POSIX && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+    const std::string crashPath = (directory / "crash.bin").string();
+    const pid_t pid = ::fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0)
+    {
+        // Doctest reports the crash of the child as a failed test of its own, keep that out of the output.
+        const int nullFd = ::open("/dev/null", O_WRONLY);
+        ::dup2(nullFd, STDOUT_FILENO);
+        ::dup2(nullFd, STDERR_FILENO);
+
+        auto pSink = std::make_shared<BlockingSink>();
+        Infra::Logger::AddSink(pSink);
+        Infra::Logger::EnableFlightRecorder(crashPath, 65536);
+        Infra::Logger::StartAsync();
+
+        Infra::Logger::LogInfo("drained before crash");
+        while (!pSink->entered)
+            std::this_thread::yield();
+
+        Infra::Logger::LogError("queued before crash {}", 1);
+        ::raise(SIGSEGV);
+        ::_exit(0);
+    }
+
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    CHECK((WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV));
+
+    std::vector<std::string> lines;
+    std::istringstream crashContent(Infra::Logger::ReadFlightRecorder(crashPath));
+    for (std::string line; std::getline(crashContent, line);)
+        lines.push_back(line);
+
+    // Drained line is written by the worker with local time, the queued one by the signal handler
+    // with nanoseconds since epoch and its unformatted format string.
+    REQUIRE(lines.size() == 2);
+    CHECK(lines[0].find(" [INFO] ") != std::string::npos);
+    CHECK(lines[0].ends_with("drained before crash"));
+    CHECK(lines[0][4] == '-');
+    CHECK(lines[1].find(" [ERROR] ") != std::string::npos);
+    CHECK(lines[1].ends_with("queued before crash {}"));
+
+    const std::string timestamp = lines[1].substr(0, lines[1].find(' '));
+    CHECK(timestamp.size() >= 19);
+    CHECK(std::all_of(timestamp.begin(), timestamp.end(), [](char c) -> bool { return c >= '0' && c <= '9'; }));
+#endif
+
+    std::filesystem::remove_all(directory);
+}
+
+struct NestedLogValue
+{
+    int value;
+};
+
+template <>
+struct std::formatter<NestedLogValue> : std::formatter<int>
+{
+    auto format(const NestedLogValue& nested, auto& context) const
+    {
+        Infra::Logger::LogInfo("nested {}", nested.value);
+        return std::formatter<int>::format(nested.value, context);
+    }
+};
+
+TEST_CASE("Sync format uses thread buffer and marks truncation")
+{
+    auto pSink = std::make_shared<CollectSink>();
+    Infra::Logger::AddSink(pSink);
+
+    const std::string longText(Infra::Logger::FORMAT_BUFFER_SIZE * 2, 'x');
+    Infra::Logger::LogInfo("{}", longText);
+    Infra::Logger::LogInfo("outer {}", NestedLogValue { 7 });
+
+    Infra::Logger::Flush();
+    Infra::Logger::RemoveSink(pSink);
+
+    REQUIRE(pSink->messages.size() == 3);
+    CHECK(pSink->messages[0].size() == Infra::Logger::FORMAT_BUFFER_SIZE - 1);
+    CHECK(pSink->messages[0].ends_with(Infra::Logger::TRUNCATED_MARKER));
+    CHECK(pSink->messages[1] == "nested 7");
+    CHECK(pSink->messages[2] == "outer 7");
+}
+
+TEST_CASE("Statistics count accepted and dropped records")
+{
+    constexpr int info = static_cast<int>(Infra::Logger::Level::Info);
+    constexpr int debug = static_cast<int>(Infra::Logger::Level::Debug);
+    constexpr int warning = static_cast<int>(Infra::Logger::Level::Warning);
+
+    auto pSink = std::make_shared<CollectSink>();
+    Infra::Logger::AddSink(pSink);
+    Infra::Logger::SetFilterLevel(Infra::Logger::Level::Info);
+
+    const auto before = Infra::Logger::GetStatistics();
+
+    for (int i = 0; i < 3; i++)
+        Infra::Logger::LogInfo("counted");
+
+    Infra::Logger::LogDebug("filtered");
+    Infra::Logger::LogDebug(std::string("filtered"));
+    Infra::Logger::Flush();
+
+    auto after = Infra::Logger::GetStatistics();
+    CHECK(after.levels[info].accepted - before.levels[info].accepted == 3);
+    CHECK(after.levels[info].bytes - before.levels[info].bytes == 3 * std::string("counted").size());
+    CHECK(after.levels[debug].accepted == before.levels[debug].accepted);
+    CHECK(after.sinkCallCount > before.sinkCallCount);
+    CHECK(after.maxSinkTimeNs <= after.sinkTimeNs);
+
+    // Counts of a thread that has exited are kept.
+    std::thread([]() -> void { Infra::Logger::LogInfo("counted"); }).join();
+    CHECK(Infra::Logger::GetStatistics().levels[info].accepted - after.levels[info].accepted == 1);
+
+    Infra::Logger::AsyncConfig config;
+    config.queueCapacity = 16;
+    config.overflowPolicy = Infra::Logger::OverflowPolicy::DropNewest;
+    REQUIRE(Infra::Logger::StartAsync(config));
+
+    // A larger queue from an earlier start is reused.
+    const size_t capacity = Infra::Logger::GetStatistics().queueCapacity;
+    CHECK(capacity >= 16);
+
+    constexpr int messageCount = 10000;
+    for (int i = 0; i < messageCount; i++)
+        Infra::Logger::LogWarn("queued");
+
+    Infra::Logger::StopAsync();
+    Infra::Logger::RemoveSink(pSink);
+
+    const auto last = Infra::Logger::GetStatistics();
+    const uint64_t dropped = last.levels[warning].dropped - after.levels[warning].dropped;
+    CHECK(last.levels[warning].accepted - after.levels[warning].accepted == messageCount);
+    CHECK(dropped == last.asyncOverflow.droppedNewest - after.asyncOverflow.droppedNewest);
+    CHECK(last.queueHighWaterMark > 0);
+    if (dropped > 0)
+        CHECK(last.queueHighWaterMark >= capacity);
+}
+
+#if PLATFORM_SUPPORT_POSIX
+static int ListenLocal(uint16_t port)
+{
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    const int reuse = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, 4) != 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static uint16_t GetLocalPort(int fd)
+{
+    sockaddr_in address {};
+    socklen_t length = sizeof(address);
+    ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+    return ntohs(address.sin_port);
+}
+
+TEST_CASE("Network sink reconnects and sends length prefixed frames")
+{
+    // Take a free port, then start without a listener so the first connects fail.
+    int listenFd = ListenLocal(0);
+    REQUIRE(listenFd >= 0);
+    const uint16_t port = GetLocalPort(listenFd);
+    ::close(listenFd);
+
+    Infra::LogNetworkSink::Config config;
+    config.sendIntervalMs = 5;
+    config.connectTimeoutMs = 200;
+    config.minReconnectDelayMs = 5;
+    config.maxReconnectDelayMs = 20;
+    auto pSink = std::make_shared<Infra::LogNetworkSink>(Infra::EndPoint(Infra::IpAddress::V4_LOCAL_HOST, port), config);
+
+    Infra::Logger::AddSink(pSink);
+    Infra::Logger::LogInfo("network first");
+    Infra::Logger::Flush();
+    CHECK_FALSE(pSink->GetStatistics().connected);
+
+    listenFd = ListenLocal(port);
+    REQUIRE(listenFd >= 0);
+
+    Infra::Logger::Log(TestNetwork, Infra::Logger::Level::Warning, "network second");
+    Infra::Logger::Flush();
+    Infra::Logger::RemoveSink(pSink);
+
+    const auto statistics = pSink->GetStatistics();
+    REQUIRE(statistics.connected);
+    CHECK(statistics.connectCount == 1);
+    CHECK(statistics.sentRecords == 2);
+
+    const int connectionFd = ::accept(listenFd, nullptr, nullptr);
+    REQUIRE(connectionFd >= 0);
+
+    timeval timeout { 2, 0 };
+    ::setsockopt(connectionFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::string received;
+    std::vector<std::string> messages;
+    std::vector<std::string> categories;
+    size_t offset = 0;
+    char buffer[1024];
+    while (messages.size() < 2)
+    {
+        const ssize_t size = ::recv(connectionFd, buffer, sizeof(buffer), 0);
+        if (size <= 0)
+            break;
+
+        received.append(buffer, static_cast<size_t>(size));
+        while (offset + 4 <= received.size())
+        {
+            const auto* p = reinterpret_cast<const unsigned char*>(received.data() + offset);
+            const size_t frameSize = (size_t(p[0]) << 24) | (size_t(p[1]) << 16) | (size_t(p[2]) << 8) | p[3];
+            if (offset + 4 + frameSize > received.size())
+                break;
+
+            const size_t nameSize = (size_t(p[23]) << 8) | p[24];
+            categories.emplace_back(received.data() + offset + 25, nameSize);
+            messages.emplace_back(received.data() + offset + 25 + nameSize, frameSize - 21 - nameSize);
+            offset += 4 + frameSize;
+        }
+    }
+
+    ::close(connectionFd);
+    ::close(listenFd);
+
+    REQUIRE(messages.size() == 2);
+    CHECK(messages[0] == "network first");
+    CHECK(categories[0] == "Default");
+    CHECK(messages[1] == "network second");
+    CHECK(categories[1] == "TestNetwork");
+}
+#endif
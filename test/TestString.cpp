@@ -1,30 +1,708 @@
-#include <iostream>
+#include <random>
+#include <cctype>
+#include <thread>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <unordered_map>
+#include <ranges>
+#include <algorithm>
+#include "DocTest.h"
+#include "Infra/PlatformDefine.h"
 #include "Infra/Utility/String.h"
-#include "Infra/Platform/Windows/Console.h"
+#include "Infra/Utility/CommandLine.h"
+#include "Infra/Utility/StringBuilder.h"
+#include "Infra/Utility/StringPool.h"
+#include "Infra/Utility/StringReplacer.h"
 
-int main()
+template <typename Encoding, typename DelimType>
+static std::vector<std::basic_string<Encoding>> RangesSplit(const std::basic_string<Encoding>& inputStr, DelimType delim)
 {
-    // Do Not Change Global Locale
-    // std::locale::global(std::locale("zh_CN"));
+    std::vector<std::basic_string<Encoding>> result;
+    for (const auto& element : std::views::split(inputStr, delim))
+        result.emplace_back(element.begin(), element.end());
 
-    // Change console output code page to UTF-8
-    Infra::Console::SetConsoleOutputUtf8();
+    return result;
+}
 
-    // Change wcout locale to zh_CN
-    std::wcout.imbue(std::locale("zh_CN"));
+TEST_CASE("Wide string conversion round trip")
+{
+    const std::string str = "测试";
+    const std::wstring wstr = Infra::String::StringToWideString(str);
+    CHECK(wstr == L"测试");
+    CHECK(Infra::String::WideStringToString(wstr) == str);
+
+    // Invalid input is replaced instead of dropping the whole string.
+    CHECK(Infra::String::StringToWideString("a\xff" "b") == L"a\uFFFDb");
+}
+
+TEST_CASE("Utf conversions round trip every kind of sequence")
+{
+    const std::string utf8 = "ascii only prefix, " "\xc3\xa9" "\xe6\xb5\x8b" "\xf0\x9f\x98\x80" " and a long ascii tail after it";
+    const std::u16string utf16 = u"ascii only prefix, \u00e9\u6d4b\U0001F600 and a long ascii tail after it";
+    const std::u32string utf32 = U"ascii only prefix, \u00e9\u6d4b\U0001F600 and a long ascii tail after it";
+
+    CHECK(Infra::String::Utf8ToUtf16(utf8) == utf16);
+    CHECK(Infra::String::Utf8ToUtf32(utf8) == utf32);
+    CHECK(Infra::String::Utf16ToUtf8(utf16) == utf8);
+    CHECK(Infra::String::Utf32ToUtf8(utf32) == utf8);
+
+    CHECK(Infra::String::Utf8ToUtf16("") == std::u16string());
+    CHECK(Infra::String::Utf32ToUtf8(U"") == std::string());
+}
+
+TEST_CASE("Utf conversions report the first invalid sequence")
+{
+    const std::vector<std::pair<std::string, size_t>> invalidUtf8 =
+    {
+        { std::string(20, 'a') + "\x80", 20 },         // Stray continuation byte
+        { "ab\xc0\xaf", 2 },                          // Overlong slash
+        { "\xe0\x80\x80", 0 },                       // Overlong nul
+        { "x\xed\xa0\x80", 1 },                      // Encoded surrogate
+        { "\xf4\x90\x80\x80", 0 },                  // Past U+10FFFF
+        { "ok\xe6\xb5", 2 },                          // Truncated at the end
+        { "\xe6" "a\x8b", 0 },                        // Missing continuation byte
+    };
+
+    for (const auto& [input, offset] : invalidUtf8)
+    {
+        size_t errorOffset = SIZE_MAX;
+        CHECK_FALSE(Infra::String::Utf8ToUtf16(input, &errorOffset).has_value());
+        CHECK(errorOffset == offset);
+        CHECK_FALSE(Infra::String::Utf8ToUtf32(input).has_value());
+    }
+
+    size_t errorOffset = SIZE_MAX;
+    CHECK_FALSE(Infra::String::Utf16ToUtf8(u"ab\xd800" u"c", &errorOffset).has_value());
+    CHECK(errorOffset == 2);
+    CHECK_FALSE(Infra::String::Utf16ToUtf8(std::u16string(1, u'\xdc00')).has_value());
+    CHECK_FALSE(Infra::String::Utf32ToUtf8(std::u32string(1, static_cast<char32_t>(0x110000))).has_value());
+}
+
+TEST_CASE("ValidateUtf8 finds the first invalid sequence at every block offset")
+{
+    // Sequences with the offset of their error.
+    const std::vector<std::pair<std::string, size_t>> invalidSequences =
+    {
+        { "\x80", 0 }, { "\xc0\xaf", 0 }, { "\xe0\x80\x80", 0 }, { "\xed\xa0\x80", 0 }, { "\xf4\x90\x80\x80", 0 },
+        { "\xf8\x88\x80\x80\x80", 0 }, { "\xe6\xb5", 0 }, { "\xe6" "a", 0 }, { "\xc3\xa9\xa9", 2 }, { "\xff", 0 },
+    };
+
+    // Padding made of every sequence length, so errors land on each position of a block.
+    const std::string units[] = { "a", "\xc3\xa9", "\xe6\xb5\x8b", "\xf0\x9f\x98\x80" };
+    for (size_t paddingSize = 0; paddingSize < 80; paddingSize++)
+    {
+        std::string padding;
+        for (size_t i = 0; padding.size() < paddingSize; i++)
+            padding += padding.size() + units[i % 4].size() <= paddingSize ? units[i % 4] : units[0];
+
+        const std::string valid = padding + "\xf4\x8f\xbf\xbf" + padding;
+        CHECK(Infra::String::ValidateUtf8(valid));
+        CHECK(Infra::String::CountCodePoints(valid) == Infra::String::Utf8ToUtf32(valid)->size());
+
+        for (const auto& [sequence, offset] : invalidSequences)
+        {
+            for (const std::string& tail : { std::string(), std::string(40, 'z') })
+            {
+                size_t errorOffset = SIZE_MAX;
+                CHECK_FALSE(Infra::String::ValidateUtf8(padding + sequence + tail, &errorOffset));
+                CHECK(errorOffset == padding.size() + offset);
+            }
+        }
+    }
+
+    CHECK(Infra::String::ValidateUtf8(""));
+    CHECK(Infra::String::CountCodePoints("") == 0);
+}
+
+TEST_CASE("ValidateUtf8 agrees with the strict decoder on random bytes")
+{
+    std::mt19937 random(11);
+    const std::string units[] = { "a", "\xc3\xa9", "\xe6\xb5\x8b", "\xf0\x9f\x98\x80", "\xed\x9f\xbf", "\xee\x80\x80" };
+
+    for (int round = 0; round < 3000; round++)
+    {
+        std::string input;
+        const size_t size = random() % 300;
+        while (input.size() < size)
+            input += units[random() % 6];
+
+        // Corrupt a few bytes, or none at all.
+        const size_t corruptCount = input.empty() ? 0 : random() % 3;
+        for (size_t i = 0; i < corruptCount; i++)
+            input[random() % input.size()] = static_cast<char>(random());
+
+        size_t expectedOffset = SIZE_MAX;
+        const auto utf32 = Infra::String::Utf8ToUtf32(input, &expectedOffset);
+
+        size_t errorOffset = SIZE_MAX;
+        CHECK(Infra::String::ValidateUtf8(input, &errorOffset) == utf32.has_value());
+        CHECK(errorOffset == expectedOffset);
+        if (utf32.has_value())
+            CHECK(Infra::String::CountCodePoints(input) == utf32->size());
+    }
+}
+
+TEST_CASE("FindByte and CountByte match a plain loop at every length and offset")
+{
+    std::mt19937 random(42);
+    std::string buffer(300, 'a');
+    for (auto& ch : buffer)
+        ch = random() % 8 == 0 ? ',' : static_cast<char>('a' + random() % 26);
+
+    for (size_t offset = 0; offset < 33; offset++)
+    {
+        for (size_t size = 0; offset + size <= buffer.size(); size++)
+        {
+            const char* pBegin = buffer.data() + offset;
+            const char* pEnd = pBegin + size;
+            REQUIRE(Infra::String::FindByte(pBegin, pEnd, ',') == std::find(pBegin, pEnd, ','));
+            REQUIRE(Infra::String::CountByte(pBegin, pEnd, ',') == static_cast<size_t>(std::count(pBegin, pEnd, ',')));
+        }
+    }
+
+    const std::string noDelimiter(200, 'x');
+    CHECK(Infra::String::FindByte(noDelimiter.data(), noDelimiter.data() + noDelimiter.size(), ',') == noDelimiter.data() + noDelimiter.size());
+
+    // Bytes above 0x7f must not be treated as signed garbage.
+    const std::string highBytes = std::string(70, 'x') + "\xff" + std::string(5, 'x');
+    CHECK(Infra::String::FindByte(highBytes.data(), highBytes.data() + highBytes.size(), '\xff') == highBytes.data() + 70);
+}
+
+TEST_CASE("Find, Count and FindAll agree with std::string_view::find")
+{
+    std::mt19937 random(5);
+    for (int round = 0; round < 2000; round++)
+    {
+        // Small alphabet so partial and full matches are common.
+        std::string haystack(random() % 200, 'a');
+        for (auto& ch : haystack)
+            ch = static_cast<char>('a' + random() % 3);
+
+        std::string needle(1 + random() % 40, 'a');
+        for (auto& ch : needle)
+            ch = static_cast<char>('a' + random() % 3);
+
+        if (needle.size() < haystack.size() && random() % 2 == 0)
+            needle = haystack.substr(random() % (haystack.size() - needle.size()), needle.size());
+
+        const std::string_view view = haystack;
+        const size_t pos = random() % (haystack.size() + 2);
+        CHECK(Infra::String::Find(view, needle, pos) == view.find(needle, pos));
+        CHECK(Infra::String::Contains(view, needle) == (view.find(needle) != std::string_view::npos));
+
+        std::vector<size_t> expected;
+        for (size_t found = view.find(needle); found != std::string_view::npos; found = view.find(needle, found + needle.size()))
+            expected.push_back(found);
+
+        CHECK(Infra::String::FindAll(view, needle) == expected);
+        CHECK(Infra::String::Count(view, needle) == expected.size());
+    }
+
+    CHECK(Infra::String::Find("abc", "", 1) == 1);
+    CHECK(Infra::String::Find("abc", "abcd") == std::string_view::npos);
+    CHECK(Infra::String::Count("aaaa", "aa") == 2);
+    CHECK(Infra::String::Count("aaaa", "") == 0);
+}
+
+TEST_CASE("FindAny returns the leftmost longest match")
+{
+    std::mt19937 random(9);
+    for (int round = 0; round < 2000; round++)
+    {
+        std::string haystack(random() % 200, 'a');
+        for (auto& ch : haystack)
+            ch = static_cast<char>('a' + random() % 4);
+
+        std::vector<std::string> needleStrs(1 + random() % 5);
+        for (auto& needle : needleStrs)
+        {
+            needle.resize(random() % 12);
+            for (auto& ch : needle)
+                ch = static_cast<char>('a' + random() % 4);
+        }
+
+        const std::vector<std::string_view> needles(needleStrs.begin(), needleStrs.end());
+
+        size_t expectedPos = std::string_view::npos;
+        size_t expectedIndex = SIZE_MAX;
+        for (size_t p = 0; p < haystack.size() && expectedIndex == SIZE_MAX; p++)
+        {
+            for (size_t i = 0; i < needles.size(); i++)
+            {
+                if (needles[i].empty() || std::string_view(haystack).substr(p, needles[i].size()) != needles[i])
+                    continue;
+
+                if (expectedIndex == SIZE_MAX || needles[i].size() > needles[expectedIndex].size())
+                {
+                    expectedPos = p;
+                    expectedIndex = i;
+                }
+            }
+        }
+
+        size_t index = SIZE_MAX;
+        CHECK(Infra::String::FindAny(haystack, needles, &index) == expectedPos);
+        CHECK(index == expectedIndex);
+    }
+}
+
+TEST_CASE("Trim views skip ascii whitespace without copying")
+{
+    const std::string str = " \t\r\n key: value \v\f";
+    CHECK(Infra::String::TrimView(str) == "key: value");
+    CHECK(Infra::String::TrimStartView(str) == "key: value \v\f");
+    CHECK(Infra::String::TrimEndView(str) == " \t\r\n key: value");
+    CHECK(Infra::String::TrimView(str).data() == str.data() + 5);
+    CHECK(Infra::String::TrimView("   ").empty());
+    CHECK(Infra::String::TrimView(std::wstring(L" wide ")) == L"wide");
+
+    // Bytes of utf-8 sequences are not whitespace.
+    CHECK(Infra::String::TrimView("\xc2\xa0x\xc2\xa0") == "\xc2\xa0x\xc2\xa0");
+
+    std::string inPlace = "  both  ";
+    Infra::String::Trim(inPlace);
+    CHECK(inPlace == "both");
+    std::wstring wideInPlace = L"\tstart";
+    Infra::String::TrimStart(wideInPlace);
+    CHECK(wideInPlace == L"start");
+}
+
+TEST_CASE("Ascii case helpers match the C locale on every byte")
+{
+    std::string allBytes;
+    for (int repeat = 0; repeat < 3; repeat++)
+    {
+        for (int ch = 0; ch < 256; ch++)
+            allBytes.push_back(static_cast<char>(ch));
+    }
+
+    // Every length and offset to cover the 16 byte, 8 byte and single byte loops.
+    for (size_t offset = 0; offset < 20; offset++)
+    {
+        for (const size_t size : { 0, 1, 7, 8, 15, 16, 17, 33, 700 })
+        {
+            const std::string input = allBytes.substr(offset, size);
+            std::string lower = input;
+            std::string upper = input;
+            Infra::String::ToLower(lower);
+            Infra::String::ToUpper(upper);
+
+            std::string expectedLower = input;
+            std::string expectedUpper = input;
+            for (size_t i = 0; i < input.size(); i++)
+            {
+                const auto ch = static_cast<unsigned char>(input[i]);
+                if (ch < 0x80)
+                {
+                    expectedLower[i] = static_cast<char>(std::tolower(ch));
+                    expectedUpper[i] = static_cast<char>(std::toupper(ch));
+                }
+            }
+
+            CHECK(lower == expectedLower);
+            CHECK(upper == expectedUpper);
+            CHECK(Infra::String::EqualsIgnoreCase(lower, upper));
+            CHECK(Infra::String::HashIgnoreCase(lower) == Infra::String::HashIgnoreCase(upper));
+        }
+    }
+
+    CHECK(Infra::String::EqualsIgnoreCase("Content-Length", "content-length"));
+    CHECK_FALSE(Infra::String::EqualsIgnoreCase("Content-Length", "content-lengtx"));
+    CHECK_FALSE(Infra::String::EqualsIgnoreCase("[", "{"));
+    CHECK_FALSE(Infra::String::EqualsIgnoreCase("\xc3\xa9", "\xc3\x89"));
+    CHECK_FALSE(Infra::String::EqualsIgnoreCase("key", "key "));
+    CHECK(Infra::String::HashIgnoreCase("a") != Infra::String::HashIgnoreCase(std::string_view("a\0", 2)));
+
+    std::unordered_map<std::string, int, Infra::String::IgnoreCaseHash, Infra::String::IgnoreCaseEqual> headerMap;
+    headerMap["Content-Type"] = 1;
+    CHECK(headerMap.find(std::string_view("CONTENT-TYPE")) != headerMap.end());
+    CHECK(headerMap.count("content-type") == 1);
+}
+
+TEST_CASE("Parse reports the error and where it was found")
+{
+    using ParseError = Infra::String::ParseError;
+
+    CHECK(Infra::String::Parse<int>("-123") == -123);
+    CHECK(Infra::String::Parse<int>("+123") == 123);
+    CHECK(Infra::String::Parse<uint64_t>("18446744073709551615") == UINT64_MAX);
+    CHECK(Infra::String::Parse<double>("2.5e-3") == 2.5e-3);
+    CHECK(Infra::String::Parse<float>("-0.5") == -0.5f);
+
+    const std::vector<std::tuple<std::string, ParseError, size_t>> failures =
+    {
+        { "", ParseError::Empty, 0 },
+        { "12a", ParseError::InvalidCharacter, 2 },
+        { " 12", ParseError::InvalidCharacter, 0 },
+        { "+-1", ParseError::InvalidCharacter, 0 },
+        { "+", ParseError::InvalidCharacter, 0 },
+        { "2147483648", ParseError::OutOfRange, 0 },
+        { "+2147483648", ParseError::OutOfRange, 1 },
+    };
+
+    for (const auto& [input, error, offset] : failures)
+    {
+        ParseError parseError = ParseError::None;
+        size_t errorOffset = SIZE_MAX;
+        CHECK_FALSE(Infra::String::Parse<int>(input, &parseError, &errorOffset).has_value());
+        CHECK(parseError == error);
+        CHECK(errorOffset == offset);
+    }
+
+    CHECK_FALSE(Infra::String::Parse<unsigned>("-1").has_value());
+    CHECK_FALSE(Infra::String::Parse<double>("1.5.2").has_value());
+}
+
+TEST_CASE("CommandLine values parse numbers with Parse and keep characters as characters")
+{
+    Infra::CommandLine::OptionMultiValue option("values");
+    option.AddValue("x");
+    option.AddValue("42");
+    option.AddValue("4x");
+
+    CHECK(option.GetValueAt<char>(0) == 'x');
+    CHECK(option.GetValueAt<unsigned char>(0) == 'x');
+    CHECK(option.GetValueAt<int>(1) == 42);
+    CHECK(option.GetValueAt<double>(1) == 42.0);
+    CHECK_THROWS_AS(option.GetValueAt<int>(2), std::invalid_argument);
+    CHECK_THROWS_AS(option.GetValueAt<char>(1), std::bad_cast);
+}
+
+TEST_CASE("ParseColumn matches Parse on every field")
+{
+    std::mt19937_64 random(3);
+    std::vector<std::string> fieldStrs;
+    for (int i = 0; i < 5000; i++)
+    {
+        // Every digit count up to 20, signs, and the odd broken field.
+        const int kind = static_cast<int>(random() % 20);
+        std::string field = kind == 0 ? "-" : kind == 1 ? "+" : "";
+        const size_t digitCount = 1 + random() % 20;
+        for (size_t d = 0; d < digitCount; d++)
+            field.push_back(static_cast<char>('0' + random() % 10));
+
+        if (kind == 2)
+            field[random() % field.size()] = 'x';
+
+        fieldStrs.push_back(field);
+    }
 
-    std::string str = "测试";
-    std::cout << str << std::endl;
-    std::wstring wstr = Infra::String::StringToWideString(str);
-    std::wcout << wstr << std::endl;
-    std::string str2 = Infra::String::WideStringToString(wstr);
-    std::cout << str2 << std::endl;
+    fieldStrs.push_back("9223372036854775807");
+    fieldStrs.push_back("-9223372036854775808");
+    fieldStrs.push_back("-9223372036854775809");
+    fieldStrs.push_back("18446744073709551615");
+    fieldStrs.push_back("18446744073709551616");
+    fieldStrs.push_back("-0");
+
+    const auto CheckColumn = [&fieldStrs]<typename T>(T)
+    {
+        for (const auto& field : fieldStrs)
+        {
+            const std::string_view view = field;
+            std::vector<T> values;
+            const bool parsed = Infra::String::ParseColumn<T>(std::span(&view, 1), values);
+            const std::optional<T> expected = Infra::String::Parse<T>(field);
+            CHECK(parsed == expected.has_value());
+            if (parsed)
+                CHECK(values[0] == *expected);
+        }
+    };
+
+    CheckColumn(int64_t());
+    CheckColumn(uint64_t());
+    CheckColumn(int32_t());
+    CheckColumn(uint16_t());
+    CheckColumn(int8_t());
+
+    const std::vector<std::string_view> column = { "1", "22", "3.5", "4" };
+    std::vector<double> doubles;
+    CHECK(Infra::String::ParseColumn<double>(column, doubles));
+    CHECK(doubles == std::vector<double>{ 1, 22, 3.5, 4 });
+
+    std::vector<int> ints;
+    size_t errorIndex = SIZE_MAX;
+    CHECK_FALSE(Infra::String::ParseColumn<int>(column, ints, &errorIndex));
+    CHECK(errorIndex == 2);
+    CHECK(ints == std::vector<int>{ 1, 22 });
+}
+
+TEST_CASE("ToChars writes into the caller buffer")
+{
+    char buffer[Infra::String::TO_CHARS_BUFFER_SIZE];
+    CHECK(Infra::String::ToChars(-42, buffer) == "-42");
+    CHECK(Infra::String::ToChars(0.1, buffer) == "0.1");
+    CHECK(Infra::String::ToChars(INT64_MIN, buffer) == "-9223372036854775808");
+    CHECK(Infra::String::ToChars(-1.7976931348623157e308, buffer).size() <= sizeof(buffer));
+
+    char small[2];
+    CHECK(Infra::String::ToChars(123, small).empty());
+}
+
+TEST_CASE("Split with a byte delimiter keeps std::views::split pieces")
+{
+    const std::vector<std::string> inputs =
+    {
+        "", ",", ",,", "a", "a,", ",a", "a,,b", "first,second,third",
+        std::string(100, 'x') + "," + std::string(40, 'y') + ",",
+    };
+
+    for (const auto& input : inputs)
+    {
+        const auto expected = RangesSplit(input, ',');
+        CHECK(Infra::String::Split(input, ',') == expected);
+
+        const auto views = Infra::String::SplitView(input, ',');
+        REQUIRE(views.size() == expected.size());
+        for (size_t i = 0; i < views.size(); i++)
+            CHECK(views[i] == expected[i]);
+    }
+
+    // Other delimiter types still go through std::views::split.
+    const std::string text = "a--b--c";
+    CHECK(Infra::String::Split(text, std::string_view("--")) == std::vector<std::string> { "a", "b", "c" });
+}
+
+static_assert(std::ranges::forward_range<Infra::SplitRange<char>>);
+
+TEST_CASE("SplitLazy yields the same pieces as SplitView")
+{
+    const std::vector<std::string> inputs = { "", ",", "a", "a,", ",a", "a,,b", "first,second,third" };
+
+    for (const auto& input : inputs)
+    {
+        std::vector<std::string_view> pieces;
+        for (const auto piece : Infra::String::SplitLazy(input, ','))
+            pieces.push_back(piece);
+
+        CHECK(pieces == Infra::String::SplitView(input, ','));
+    }
+
+    // Works on any string_view and other encodings without copying.
+    const std::string_view line = "key=value=more";
+    CHECK(std::ranges::distance(Infra::String::SplitLazy(line, '=')) == 3);
+
+    std::vector<std::wstring_view> widePieces;
+    for (const auto piece : Infra::String::SplitLazy(std::wstring_view(L"x;y"), L';'))
+        widePieces.push_back(piece);
+
+    CHECK(widePieces == std::vector<std::wstring_view> { L"x", L"y" });
+}
+
+TEST_CASE("SplitLazy with max pieces keeps the rest unsplit")
+{
+    std::vector<std::string_view> pieces;
+    for (const auto piece : Infra::String::SplitLazy("a,b,c,d", ',', 2))
+        pieces.push_back(piece);
+
+    CHECK(pieces == std::vector<std::string_view> { "a", "b,c,d" });
+
+    pieces.clear();
+    for (const auto piece : Infra::String::SplitLazy("a,b", ',', 5))
+        pieces.push_back(piece);
+
+    CHECK(pieces == std::vector<std::string_view> { "a", "b" });
+
+    CHECK(std::ranges::distance(Infra::String::SplitLazy("a,b", ',', 0)) == 0);
+    CHECK(std::ranges::distance(Infra::String::SplitLazy("a,b,", ',', 3)) == 3);
+
+    // Early exit only scans up to the pieces it needs.
+    const std::string line = "id,name," + std::string(1000, 'x');
+    auto itr = Infra::String::SplitLazy(line, ',').begin();
+    CHECK(*itr == "id");
+    CHECK(*++itr == "name");
+}
+
+TEST_CASE("Join accepts any range of string-like values")
+{
+    const std::vector<std::string> strVec = { "a", "bc", "", "d" };
+    CHECK(Infra::String::Join(strVec, std::string(", ")) == "a, bc, , d");
+    CHECK(Infra::String::Join(strVec, ',') == "a,bc,,d");
+    CHECK(Infra::String::Join(std::vector<std::string>{}, ",").empty());
+    CHECK(Infra::String::Join(std::vector<std::string>{ "only" }, ",") == "only");
+
+    const std::string_view views[] = { "x", "y", "z" };
+    CHECK(Infra::String::Join(views, "--") == "x--y--z");
+
+    const std::vector<const char*> cStrings = { "p", "q" };
+    CHECK(Infra::String::Join(cStrings, std::string_view("/")) == "p/q");
+
+    const std::vector<std::wstring> wideVec = { L"1", L"2" };
+    CHECK(Infra::String::Join(wideVec, L'+') == L"1+2");
+
+    // Lazy ranges work too.
+    CHECK(Infra::String::Join(Infra::String::SplitLazy("a b c", ' '), '_') == "a_b_c");
+}
+
+TEST_CASE("StringBuilder chains appends")
+{
+    Infra::StringBuilder builder(64);
+    builder.Append("id=").Append(42).Append(',').Append(std::string("name")).Append('=').Append(std::string_view("x"));
+    builder.Append(' ').Append(-1.5).Append('-', 3).AppendLine();
+    builder.AppendJoin(std::vector<std::string> { "a", "b" }, ", ");
+
+    CHECK(builder.View() == "id=42,name=x -1.5---\na, b");
+    CHECK(builder.Size() == builder.View().size());
+
+    const std::string result = std::move(builder).ToString();
+    CHECK(result == "id=42,name=x -1.5---\na, b");
+
+    Infra::WideStringBuilder wideBuilder;
+    wideBuilder.Append(L"n=").Append(7u).Append(L'!');
+    CHECK(wideBuilder.ToString() == L"n=7!");
+
+    builder.Clear();
+    CHECK(builder.Empty());
+}
+
+TEST_CASE("Replace handles growing, shrinking and same length patterns")
+{
+    std::string str = "a.b.c";
+    Infra::String::Replace(str, std::string("."), std::string("::"));
+    CHECK(str == "a::b::c");
+
+    Infra::String::Replace(str, std::string("::"), std::string(""));
+    CHECK(str == "abc");
+
+    Infra::String::Replace(str, std::string("b"), std::string("x"));
+    CHECK(str == "axc");
+
+    Infra::String::Replace(str, std::string(""), std::string("y"));
+    CHECK(str == "axc");
+
+    CHECK(Infra::String::ReplaceCopy<char>("aaaa", "aa", "b") == "bb");
+    CHECK(Infra::String::ReplaceCopy<char>("xyz", "q", "b") == "xyz");
+    CHECK(Infra::String::ReplaceCopy<wchar_t>(L"1-2", L"-", L"+") == L"1+2");
+}
+
+// Leftmost longest, non-overlapping, tried at every position.
+static std::string BruteForceReplaceAll(std::string_view input, const std::vector<Infra::StringReplacer::Pair>& pairs)
+{
+    std::string result;
+    size_t pos = 0;
+    while (pos < input.size())
+    {
+        const Infra::StringReplacer::Pair* pBest = nullptr;
+        for (const auto& pair : pairs)
+        {
+            if (!pair.first.empty() && input.substr(pos).starts_with(pair.first) && (pBest == nullptr || pair.first.size() > pBest->first.size()))
+                pBest = &pair;
+        }
+
+        if (pBest == nullptr)
+        {
+            result.push_back(input[pos++]);
+            continue;
+        }
+
+        result.append(pBest->second);
+        pos += pBest->first.size();
+    }
+
+    return result;
+}
+
+TEST_CASE("StringReplacer replaces leftmost longest matches in one scan")
+{
+    const Infra::StringReplacer replacer({ { "{name}", "World" }, { "{greeting}", "Hello" }, { "", "ignored" } });
+    CHECK(replacer.GetPatternCount() == 2);
+    CHECK(replacer.Replace("{greeting}, {name}! {unknown}") == "Hello, World! {unknown}");
+
+    CHECK(Infra::String::ReplaceAll("abcd", { { "bc", "1" }, { "abc", "2" }, { "cd", "3" } }) == "2d");
+    CHECK(Infra::String::ReplaceAll("she sells", { { "he", "X" }, { "she", "Y" }, { "s", "Z" } }) == "Y ZellZ");
+    CHECK(Infra::String::ReplaceAll("", { { "a", "b" } }).empty());
+    CHECK(Infra::String::ReplaceAll("abc", {}) == "abc");
+
+    std::string output = "prefix:";
+    replacer.Replace("{name}", output);
+    CHECK(output == "prefix:World");
+
+    std::mt19937 random(3);
+    for (int round = 0; round < 200; round++)
+    {
+        std::vector<Infra::StringReplacer::Pair> pairs;
+        const int patternCount = 1 + static_cast<int>(random() % 6);
+        for (int i = 0; i < patternCount; i++)
+        {
+            std::string from(1 + random() % 4, 'a');
+            for (auto& ch : from)
+                ch = static_cast<char>('a' + random() % 3);
+
+            pairs.emplace_back(from, std::to_string(i));
+        }
+
+        std::string input(random() % 64, 'a');
+        for (auto& ch : input)
+            ch = static_cast<char>('a' + random() % 4);
+
+        REQUIRE(Infra::StringReplacer(pairs).Replace(input) == BruteForceReplaceAll(input, pairs));
+    }
+}
+
+TEST_CASE("StringPool gives equal strings the same id and keeps views stable")
+{
+    Infra::StringPool pool(Infra::StringPool::Config{ .blockSize = 64 });
+
+    const auto hostId = pool.Intern("host");
+    const auto portId = pool.Intern(std::string("port"));
+    CHECK(hostId != portId);
+    CHECK(pool.Intern(std::string_view("host-name").substr(0, 4)) == hostId);
+    CHECK(pool.Intern("") == pool.Intern(std::string()));
+
+    // Strings past the block size and enough short ones to fill several blocks.
+    const std::string longStr(1000, 'x');
+    const auto longId = pool.Intern(longStr);
+    const std::string_view hostView = pool.GetView(hostId);
+    for (int i = 0; i < 200; i++)
+        pool.Intern("key" + std::to_string(i));
+
+    CHECK(pool.GetView(longId) == longStr);
+    CHECK(pool.GetView(hostId).data() == hostView.data());
+    CHECK(pool.GetView(portId) == "port");
+    CHECK(pool.Size() == 204);
+    CHECK(pool.Find("key7") == pool.Intern("key7"));
+    CHECK_FALSE(pool.Find("missing").has_value());
+    CHECK(pool.Size() == 204);
+
+    const std::vector<std::string> header = { "name", "host", "name", "" };
+    const auto ids = pool.InternBulk(header);
+    REQUIRE(ids.size() == 4);
+    CHECK(ids[0] == ids[2]);
+    CHECK(ids[1] == hostId);
+    CHECK(pool.GetView(ids[0]) == "name");
+}
+
+TEST_CASE("Thread safe StringPool agrees on ids across threads")
+{
+    Infra::StringPool pool(Infra::StringPool::Config{ .threadSafe = true });
 
-    std::wstring str3 = L"测试";
-    std::string str4 = Infra::String::WideStringToString(wstr);
-    std::cout << str4 << std::endl;
+    constexpr int THREAD_COUNT = 4;
+    constexpr int KEY_COUNT = 2000;
+    std::vector<std::vector<Infra::StringPool::Id>> threadIds(THREAD_COUNT);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREAD_COUNT; t++)
+    {
+        threads.emplace_back([&pool, &threadIds, t]()
+        {
+            // Every thread interns the same keys in its own order.
+            for (int i = 0; i < KEY_COUNT; i++)
+            {
+                const int key = (i * 7 + t * 13) % KEY_COUNT;
+                threadIds[t].push_back(pool.Intern("key" + std::to_string(key)));
+            }
+        });
+    }
 
-    system("pause");
+    for (auto& thread : threads)
+        thread.join();
 
-    return 0;
-}
\ No newline at end of file
+    CHECK(pool.Size() == KEY_COUNT);
+    for (int t = 0; t < THREAD_COUNT; t++)
+    {
+        for (int i = 0; i < KEY_COUNT; i++)
+        {
+            const int key = (i * 7 + t * 13) % KEY_COUNT;
+            CHECK(pool.GetView(threadIds[t][i]) == "key" + std::to_string(key));
+        }
+    }
+}